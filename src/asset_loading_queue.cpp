@@ -0,0 +1,143 @@
+/*
+ * asset_loading_queue.cpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#include "asset_loading_queue.hpp"
+
+#include "audio/audio_loader.hpp"
+#include "audio/sound_cache.hpp"
+
+#include "gfx/image_cache.hpp"
+
+#include "futil/language.hpp"
+
+using std::string;
+using std::vector;
+using fgeal::Image;
+using fgeal::Sound;
+
+namespace  // anonymous
+{
+	struct ImageLoadingJob extends AssetLoadingQueue::Job
+	{
+		string filename;
+		vector<Image*>& heldImages;
+
+		ImageLoadingJob(const string& filename, vector<Image*>& heldImages) : filename(filename), heldImages(heldImages) {}
+
+		void run()
+		{
+			heldImages.push_back(ImageCache::acquire(filename));
+		}
+	};
+
+	struct SoundLoadingJob extends AssetLoadingQueue::Job
+	{
+		string filename;
+		unsigned instance;
+		vector<Sound*>& heldSounds;
+
+		SoundLoadingJob(const string& filename, unsigned instance, vector<Sound*>& heldSounds) : filename(filename), instance(instance), heldSounds(heldSounds) {}
+
+		void run()
+		{
+			heldSounds.push_back(SoundCache::acquire(filename, instance));
+		}
+	};
+
+	struct MusicLoadingJob extends AssetLoadingQueue::Job
+	{
+		string filename;
+
+		MusicLoadingJob(const string& filename) : filename(filename) {}
+
+		void run()
+		{
+			AudioLoader::prefetchMusic(filename);
+			AudioLoader::process();
+		}
+	};
+}
+
+AssetLoadingQueue::AssetLoadingQueue()
+: pendingJobs(), heldImages(), heldSounds(), jobCount(0), finishedJobCount(0)
+{}
+
+AssetLoadingQueue::~AssetLoadingQueue()
+{
+	clear();
+}
+
+void AssetLoadingQueue::add(Job* job)
+{
+	pendingJobs.push_back(job);
+	jobCount++;
+}
+
+void AssetLoadingQueue::addImage(const string& filename)
+{
+	add(new ImageLoadingJob(filename, heldImages));
+}
+
+void AssetLoadingQueue::addSound(const string& filename, unsigned instance)
+{
+	add(new SoundLoadingJob(filename, instance, heldSounds));
+}
+
+void AssetLoadingQueue::addMusic(const string& filename)
+{
+	add(new MusicLoadingJob(filename));
+}
+
+bool AssetLoadingQueue::process(float timeBudget)
+{
+	const double deadline = fgeal::uptime() + timeBudget;
+	while(not pendingJobs.empty())
+	{
+		Job* const job = pendingJobs.front();
+		pendingJobs.pop_front();
+		try { job->run(); }
+		catch(...) { delete job; throw; }
+		delete job;
+		finishedJobCount++;
+
+		if(fgeal::uptime() >= deadline)
+			break;
+	}
+	return isDone();
+}
+
+bool AssetLoadingQueue::isDone() const
+{
+	return pendingJobs.empty();
+}
+
+float AssetLoadingQueue::getProgress() const
+{
+	if(jobCount == 0)
+		return 1;
+
+	return static_cast<float>(finishedJobCount) / jobCount;
+}
+
+void AssetLoadingQueue::clear()
+{
+	for(unsigned i = 0; i < pendingJobs.size(); i++)
+		delete pendingJobs[i];
+
+	pendingJobs.clear();
+
+	for(unsigned i = 0; i < heldImages.size(); i++)
+		ImageCache::release(heldImages[i]);
+
+	heldImages.clear();
+
+	for(unsigned i = 0; i < heldSounds.size(); i++)
+		SoundCache::release(heldSounds[i]);
+
+	heldSounds.clear();
+	jobCount = finishedJobCount = 0;
+}
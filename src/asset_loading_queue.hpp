@@ -0,0 +1,80 @@
+/*
+ * asset_loading_queue.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef ASSET_LOADING_QUEUE_HPP_
+#define ASSET_LOADING_QUEUE_HPP_
+#include <ciso646>
+
+#include "fgeal/fgeal.hpp"
+
+#include <deque>
+#include <vector>
+#include <string>
+
+/** A queue of asset loading jobs, run on the main thread in time slices (a few jobs per frame), so that a loading screen can be rendered
+ *  while assets are loaded, instead of freezing the window. Each image, sound and music is a job of its own. Assets are not loaded in
+ *  background, since images may be textures owned by the graphics backend, and audio backends are not guaranteed to be thread-safe. */
+class AssetLoadingQueue
+{
+	public:
+
+	/** A loading job, run on the main thread. */
+	struct Job
+	{
+		virtual ~Job() {}
+		virtual void run() = 0;
+	};
+
+	private:
+
+	// the jobs not yet run (owned by this queue)
+	std::deque<Job*> pendingJobs;
+
+	// images and sounds loaded by this queue, held until clear() so that they stay cached until used
+	std::vector<fgeal::Image*> heldImages;
+	std::vector<fgeal::Sound*> heldSounds;
+
+	// how many jobs were added and how many were run since the last clear()
+	unsigned jobCount, finishedJobCount;
+
+	AssetLoadingQueue(const AssetLoadingQueue&);  // not copyable
+	AssetLoadingQueue& operator=(const AssetLoadingQueue&);
+
+	public:
+
+	AssetLoadingQueue();
+	~AssetLoadingQueue();
+
+	/** Adds the given job to the queue, which takes ownership of it. */
+	void add(Job* job);
+
+	/** Adds a job that loads the given image file into the ImageCache (held until clear(), so it's there when acquired afterwards). */
+	void addImage(const std::string& filename);
+
+	/** Adds a job that loads the given sound file into the SoundCache (held until clear(), like images). The 'instance' number is the
+	 *  same as in SoundCache::acquire(). */
+	void addSound(const std::string& filename, unsigned instance=0);
+
+	/** Adds a job that loads the given music file through the AudioLoader, to be taken with AudioLoader::takeMusic() (a no-op if it was
+	 *  already prefetched). */
+	void addMusic(const std::string& filename);
+
+	/** Runs pending jobs until the given time budget (in seconds) is spent; at least one job is run, if any. Returns true if done. Any
+	 *  exception thrown by a job is passed on to the caller (the job is discarded). */
+	bool process(float timeBudget);
+
+	/** Returns true if all jobs were run. */
+	bool isDone() const;
+
+	/** Returns the fraction of jobs done since the last clear(), in the range [0, 1]. */
+	float getProgress() const;
+
+	/** Discards pending jobs, releases held images and sounds and resets the progress. */
+	void clear();
+};
+
+#endif /* ASSET_LOADING_QUEUE_HPP_ */
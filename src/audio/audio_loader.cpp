@@ -0,0 +1,73 @@
+/*
+ * audio_loader.cpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#include "audio_loader.hpp"
+
+#include "futil/language.hpp"
+
+using std::string;
+using fgeal::Music;
+
+namespace  // anonymous
+{
+	// the most recently requested music; 'music' is null while it's pending (or if loading it failed)
+	string requestedMusicFilename;
+	Music* music = null;
+	bool musicPending = false;
+}
+
+void AudioLoader::prefetchMusic(const string& filename)
+{
+	if(filename == requestedMusicFilename)
+		return;
+
+	if(music != null)
+	{
+		delete music;
+		music = null;
+	}
+	requestedMusicFilename = filename;
+	musicPending = true;
+}
+
+void AudioLoader::process()
+{
+	if(musicPending)
+	{
+		musicPending = false;
+		try { music = new Music(requestedMusicFilename); }
+		catch(...) {}  // the error is reported when the music is taken, as it gets loaded again then
+	}
+}
+
+Music* AudioLoader::takeMusic(const string& filename)
+{
+	Music* takenMusic = null;
+	if(requestedMusicFilename == filename)
+	{
+		takenMusic = music;
+		music = null;
+		musicPending = false;
+		requestedMusicFilename.clear();
+	}
+
+	if(takenMusic == null)  // not prefetched (or failed to), load it now
+		takenMusic = new Music(filename);
+
+	return takenMusic;
+}
+
+void AudioLoader::shutdown()
+{
+	if(music != null)
+	{
+		delete music;
+		music = null;
+	}
+	requestedMusicFilename.clear();
+	musicPending = false;
+}
@@ -0,0 +1,43 @@
+/*
+ * audio_loader.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef AUDIO_AUDIO_LOADER_HPP_
+#define AUDIO_AUDIO_LOADER_HPP_
+#include <ciso646>
+
+#include "fgeal/fgeal.hpp"
+
+#include <string>
+
+/** A music prefetching service. A music can be requested ahead of time (i.e. while browsing courses), so that it's ready by the time
+ *  it's needed; it's loaded on a later call to process(), so that requests made while the selection moves fast don't pile up. Only the
+ *  most recently requested music is kept until taken. Music is streamed from its file by fgeal as it plays, so loading it only opens
+ *  the file and decodes its first chunk.
+ *  Loading is done on the main thread, since audio backends are not guaranteed to be thread-safe (sounds, which are fully decoded when
+ *  loaded, are loaded in time slices by the AssetLoadingQueue instead). Like the SoundCache, this must only be used from the main thread. */
+class AudioLoader
+{
+	AudioLoader();  // not instantiable
+
+	public:
+
+	/** Requests the music in the given file to be loaded on the next call to process(), discarding any previously prefetched music not
+	 *  yet taken. Requesting the same music again is a no-op. */
+	static void prefetchMusic(const std::string& filename);
+
+	/** Loads the requested music, if not yet loaded. A music that fails to load is skipped, so that the error surfaces when it's taken. */
+	static void process();
+
+	/** Returns the music in the given file, loading it right away if it wasn't prefetched. The caller takes ownership of the returned
+	 *  music. Throws an exception if the file can't be loaded. */
+	static fgeal::Music* takeMusic(const std::string& filename);
+
+	/** Frees the prefetched music not yet taken. Should be called before finalizing fgeal. */
+	static void shutdown();
+};
+
+#endif /* AUDIO_AUDIO_LOADER_HPP_ */
@@ -0,0 +1,181 @@
+/*
+ * engine_voice_manager.cpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#include "engine_voice_manager.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+using std::vector;
+
+static const float REFERENCE_DISTANCE = 6,  // sources closer than this are heard at full volume, in meters
+				   MAXIMUM_DISTANCE = 200,  // sources farther than this are not heard at all, in meters
+				   FULL_LOUDNESS_SPEED = 30,  // the speed from which sources are deemed fully loud, when ranking them, in m/s
+				   SPEED_OF_SOUND = 343,  // in m/s
+				   MAXIMUM_DOPPLER_CLOSING_SPEED = 0.5 * SPEED_OF_SOUND,  // closing speeds are clamped to this, to keep the Doppler factor sane
+				   VOICED_SOURCE_SCORE_BONUS = 1.25;  // sources already being played are favored when ranking, so voices don't jump back and forth
+
+namespace  // anonymous
+{
+	// sorts indexes by descending score
+	struct ScoreComparator
+	{
+		const vector<float>& scores;
+		ScoreComparator(const vector<float>& scores) : scores(scores) {}
+		bool operator()(unsigned a, unsigned b) const { return scores[a] > scores[b]; }
+	};
+}
+
+EngineVoiceManager::EngineVoiceManager()
+: volume(1), voices(), sourceGains(), sourceScores(), candidateIndexes(), sourceSelections()
+{}
+
+void EngineVoiceManager::reset(unsigned voiceCount)
+{
+	halt();
+	voices.clear();
+
+	Voice emptyVoice;
+	emptyVoice.sourceIndex = -1;
+	emptyVoice.profileIndex = 0;
+	voices.resize(voiceCount, emptyVoice);
+}
+
+unsigned EngineVoiceManager::addProfile(const EngineSoundSimulator& simulator)
+{
+	for(unsigned v = 0; v < voices.size(); v++)
+	{
+		voices[v].simulators.push_back(simulator);
+		voices[v].simulators.back().freeAssetsData();  // in case the given simulator had its sounds loaded; each voice loads its own
+		voices[v].profileLoaded.push_back(false);
+	}
+	return voices.empty()? 0 : voices[0].simulators.size()-1;
+}
+
+float EngineVoiceManager::computeGain(float distance)
+{
+	if(distance >= MAXIMUM_DISTANCE)
+		return 0;
+
+	if(distance <= REFERENCE_DISTANCE)
+		return 1;
+
+	// inverse distance law, shifted so that it reaches zero at the maximum distance
+	static const float gainAtMaximumDistance = REFERENCE_DISTANCE / MAXIMUM_DISTANCE;
+	return (REFERENCE_DISTANCE / distance - gainAtMaximumDistance) / (1 - gainAtMaximumDistance);
+}
+
+void EngineVoiceManager::update(const vector<Source>& sources)
+{
+	const unsigned sourceCount = sources.size();
+	sourceGains.resize(sourceCount);
+	sourceScores.resize(sourceCount);
+	sourceSelections.assign(sourceCount, false);
+	candidateIndexes.clear();
+
+	// rank audible sources by their gain, weighted by their speed (faster vehicles are louder)
+	for(unsigned i = 0; i < sourceCount; i++)
+	{
+		sourceGains[i] = computeGain(sources[i].distance);
+		if(sourceGains[i] > 0)
+		{
+			const float loudness = 0.5f + 0.5f * std::min(1.0f, std::max(sources[i].speed, 0.0f) / FULL_LOUDNESS_SPEED);
+			sourceScores[i] = sourceGains[i] * loudness;
+			candidateIndexes.push_back(i);
+		}
+	}
+
+	for(unsigned v = 0; v < voices.size(); v++)
+		if(voices[v].sourceIndex >= 0 and voices[v].sourceIndex < (int) sourceCount)
+			sourceScores[voices[v].sourceIndex] *= VOICED_SOURCE_SCORE_BONUS;
+
+	// select the best ones, up to the number of voices
+	if(candidateIndexes.size() > voices.size())
+	{
+		std::nth_element(candidateIndexes.begin(), candidateIndexes.begin() + voices.size(), candidateIndexes.end(), ScoreComparator(sourceScores));
+		candidateIndexes.resize(voices.size());
+	}
+
+	for(unsigned c = 0; c < candidateIndexes.size(); c++)
+		sourceSelections[candidateIndexes[c]] = true;
+
+	// free voices whose sources weren't selected; voices keep their sources if still selected
+	for(unsigned v = 0; v < voices.size(); v++)
+	{
+		Voice& voice = voices[v];
+		if(voice.sourceIndex < 0)
+			continue;
+
+		if(voice.sourceIndex < (int) sourceCount and sourceSelections[voice.sourceIndex])
+			sourceSelections[voice.sourceIndex] = false;  // already has a voice
+		else
+		{
+			voice.simulators[voice.profileIndex].halt();
+			voice.sourceIndex = -1;
+		}
+	}
+
+	// assign free voices to the selected sources that have no voice yet
+	unsigned nextVoice = 0;
+	for(unsigned c = 0; c < candidateIndexes.size(); c++)
+		if(sourceSelections[candidateIndexes[c]])
+		{
+			while(voices[nextVoice].sourceIndex >= 0)
+				nextVoice++;
+
+			// free voices were halted above, so switching profiles needs nothing else, unless this voice never played the profile before
+			Voice& voice = voices[nextVoice];
+			voice.sourceIndex = candidateIndexes[c];
+			voice.profileIndex = sources[candidateIndexes[c]].profileIndex;
+			if(not voice.profileLoaded[voice.profileIndex])
+			{
+				// instance 0 is the shared one (i.e. the player's), each voice has its own; if loading fails, the voice just stays silent
+				// (see EngineSoundSimulator::update()), as it's not worth aborting the race for, and it's not attempted again
+				EngineSoundSimulator& simulator = voice.simulators[voice.profileIndex];
+				try { simulator.loadAssetsData(nextVoice+1); }
+				catch(const std::exception& e)
+				{
+					std::cout << "warning: could not load engine sound: " << e.what() << std::endl;
+					simulator.freeAssetsData();
+				}
+				voice.profileLoaded[voice.profileIndex] = true;
+			}
+		}
+
+	// play the voiced sources
+	for(unsigned v = 0; v < voices.size(); v++)
+		if(voices[v].sourceIndex >= 0)
+		{
+			const Source& source = sources[voices[v].sourceIndex];
+			EngineSoundSimulator& simulator = voices[v].simulators[source.profileIndex];
+			const float closingSpeed = std::max(-MAXIMUM_DOPPLER_CLOSING_SPEED, std::min(source.closingSpeed, MAXIMUM_DOPPLER_CLOSING_SPEED));
+			simulator.setVolume(volume * sourceGains[voices[v].sourceIndex]);
+			simulator.update(source.rpm, source.load, SPEED_OF_SOUND / (SPEED_OF_SOUND - closingSpeed));
+		}
+}
+
+void EngineVoiceManager::halt()
+{
+	for(unsigned v = 0; v < voices.size(); v++)
+	{
+		for(unsigned p = 0; p < voices[v].simulators.size(); p++)
+			voices[v].simulators[p].halt();
+
+		voices[v].sourceIndex = -1;
+	}
+}
+
+unsigned EngineVoiceManager::getActiveVoiceCount() const
+{
+	unsigned count = 0;
+	for(unsigned v = 0; v < voices.size(); v++)
+		if(voices[v].sourceIndex >= 0)
+			count++;
+
+	return count;
+}
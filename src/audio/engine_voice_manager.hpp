@@ -0,0 +1,83 @@
+/*
+ * engine_voice_manager.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef AUDIO_ENGINE_VOICE_MANAGER_HPP_
+#define AUDIO_ENGINE_VOICE_MANAGER_HPP_
+#include <ciso646>
+
+#include "automotive/engine_sound.hpp"
+
+#include <vector>
+
+/** Plays the engine sounds of many sources (i.e. traffic and opponent vehicles) through a small, fixed number of voices. On each
+ *  update, the most audible sources (by distance and speed) are assigned a voice, which plays their engine sound with distance
+ *  attenuation and Doppler shift; all other sources are virtualized, costing nothing besides having their audibility evaluated.
+ *  Each voice holds its own instance of the sounds of each profile (see EngineSoundSimulator::loadAssetsData()), so that sources with
+ *  the same profile can be heard at the same time. A voice loads its instance of a profile's sounds when it's first assigned a source
+ *  with that profile, and keeps it until the next reset, so that moving a voice between sources does not load anything afterwards. */
+class EngineVoiceManager
+{
+	public:
+
+	/** A sound source, as heard by the listener. */
+	struct Source
+	{
+		unsigned profileIndex;  // the index of the source's profile, as returned by addProfile()
+		float distance;  // the distance between the source and the listener, in meters
+		float closingSpeed;  // the speed at which the source approaches the listener (negative if moving away), in m/s
+		float speed;  // the source's own speed, in m/s
+		float rpm, load;  // the source's engine RPM and load (see EngineSoundSimulator::update())
+	};
+
+	/** The overall volume of all voices, in the range [0,1]. */
+	float volume;
+
+	EngineVoiceManager();
+
+	/** Stops all voices and removes all profiles (releasing their sounds), then sets the number of voices to be used from now on.
+	 *  Released sounds are kept by the SoundCache for a while, so that voices playing the same profiles again don't decode them again. */
+	void reset(unsigned voiceCount);
+
+	/** Adds a profile to be played by the voices, taken from the given simulator (which must have its profile set; it doesn't need to
+	 *  have its sounds loaded). Nothing is loaded until a voice plays the profile. Returns the index of the added profile, to be used by sources. */
+	unsigned addProfile(const EngineSoundSimulator& simulator);
+
+	/** Reevaluates which sources should be heard and updates the voices accordingly. Sources must be given in the same order on every
+	 *  update (i.e. the same index for the same source), otherwise voices may jump between sources. */
+	void update(const std::vector<Source>& sources);
+
+	/** Stops all voices (they resume on the next update). */
+	void halt();
+
+	/** Returns the number of voices currently playing a source. */
+	unsigned getActiveVoiceCount() const;
+
+	/** Returns the number of voices. */
+	inline unsigned getVoiceCount() const { return voices.size(); }
+
+	/** Returns the gain (distance attenuation) used for sources at the given distance (in meters), in the range [0,1]. */
+	static float computeGain(float distance);
+
+	private:
+
+	struct Voice
+	{
+		std::vector<EngineSoundSimulator> simulators;  // one for each profile, with this voice's own instance of the sounds
+		std::vector<bool> profileLoaded;  // whether this voice's instance of each profile's sounds was loaded (loaded when first needed)
+		int sourceIndex;  // the index of the source being played by this voice, or -1 if none
+		unsigned profileIndex;  // the index of the profile being played by this voice (only meaningful if playing a source)
+	};
+
+	std::vector<Voice> voices;
+
+	// reused on every update, to avoid reallocations
+	std::vector<float> sourceGains, sourceScores;
+	std::vector<unsigned> candidateIndexes;
+	std::vector<bool> sourceSelections;
+};
+
+#endif /* AUDIO_ENGINE_VOICE_MANAGER_HPP_ */
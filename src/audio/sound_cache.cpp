@@ -0,0 +1,141 @@
+/*
+ * sound_cache.cpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#include "sound_cache.hpp"
+
+#include "futil/language.hpp"
+
+#include <map>
+
+#include <sys/stat.h>
+
+using std::string;
+using std::map;
+using std::pair;
+using fgeal::Sound;
+
+// sounds are decoded when loaded, so compressed files take this many times their file size in memory (a rough estimate for ogg files)
+static const unsigned long COMPRESSED_SOUND_DECODED_SIZE_FACTOR = 10;
+
+namespace  // anonymous
+{
+	struct CacheEntry
+	{
+		Sound* sound;
+		unsigned referenceCount;
+		unsigned long size;  // estimated memory taken by the sound, in bytes
+		unsigned long lastReleaseOrder;  // when this entry was last released, for eviction
+	};
+
+	// keyed by filename and instance number
+	typedef pair<string, unsigned> CacheKey;
+	map<CacheKey, CacheEntry> entries;
+	unsigned long releaseCounter = 0, memoryBudget = 64*1024*1024, unreferencedMemoryUsage = 0, memoryUsage = 0;
+	bool retainingUnreferenced = true;
+}
+
+static map<CacheKey, CacheEntry>::iterator findEntry(Sound* sound)
+{
+	for(map<CacheKey, CacheEntry>::iterator it = entries.begin(); it != entries.end(); ++it)
+		if(it->second.sound == sound)
+			return it;
+
+	return entries.end();
+}
+
+// frees the least recently released, unreferenced sounds, until they fit within the given budget; a zero budget frees all of them,
+// including ones of unknown size
+static void evictUnreferenced(unsigned long budget)
+{
+	while(budget == 0 or unreferencedMemoryUsage > budget)
+	{
+		map<CacheKey, CacheEntry>::iterator oldest = entries.end();
+		for(map<CacheKey, CacheEntry>::iterator it = entries.begin(); it != entries.end(); ++it)
+			if(it->second.referenceCount == 0 and (oldest == entries.end() or it->second.lastReleaseOrder < oldest->second.lastReleaseOrder))
+				oldest = it;
+
+		if(oldest == entries.end())
+			return;
+
+		unreferencedMemoryUsage -= oldest->second.size;
+		memoryUsage -= oldest->second.size;
+		delete oldest->second.sound;
+		entries.erase(oldest);
+	}
+}
+
+// returns an estimate of the memory taken by the sound in the given file once loaded (fgeal doesn't tell), based on the file's size
+static unsigned long estimateDecodedSize(const string& filename)
+{
+	struct stat fileStatus;
+	if(stat(filename.c_str(), &fileStatus) != 0)
+		return 0;
+
+	const bool uncompressed = filename.size() >= 4 and (filename.compare(filename.size()-4, 4, ".wav") == 0 or filename.compare(filename.size()-4, 4, ".WAV") == 0);
+	return static_cast<unsigned long>(fileStatus.st_size) * (uncompressed? 1 : COMPRESSED_SOUND_DECODED_SIZE_FACTOR);
+}
+
+Sound* SoundCache::acquire(const string& filename, unsigned instance)
+{
+	const CacheKey key(filename, instance);
+	map<CacheKey, CacheEntry>::iterator it = entries.find(key);
+	if(it == entries.end())
+	{
+		const CacheEntry entry = { new Sound(filename), 0, estimateDecodedSize(filename), 0 };
+		it = entries.insert(std::make_pair(key, entry)).first;
+		memoryUsage += entry.size;
+		unreferencedMemoryUsage += entry.size;  // until referenced (below)
+	}
+
+	if(it->second.referenceCount++ == 0)
+		unreferencedMemoryUsage -= it->second.size;
+
+	return it->second.sound;
+}
+
+void SoundCache::retain(Sound* sound)
+{
+	map<CacheKey, CacheEntry>::iterator it = findEntry(sound);
+	if(it != entries.end() and it->second.referenceCount++ == 0)
+		unreferencedMemoryUsage -= it->second.size;
+}
+
+void SoundCache::release(Sound* sound)
+{
+	if(sound == null)
+		return;
+
+	map<CacheKey, CacheEntry>::iterator it = findEntry(sound);
+	if(it != entries.end() and it->second.referenceCount > 0 and --it->second.referenceCount == 0)
+	{
+		it->second.lastReleaseOrder = ++releaseCounter;
+		unreferencedMemoryUsage += it->second.size;
+		evictUnreferenced(retainingUnreferenced? memoryBudget : 0);
+	}
+}
+
+void SoundCache::setMemoryBudget(unsigned long bytes)
+{
+	memoryBudget = bytes;
+	evictUnreferenced(retainingUnreferenced? memoryBudget : 0);
+}
+
+unsigned long SoundCache::getMemoryUsage()
+{
+	return memoryUsage;
+}
+
+void SoundCache::purge()
+{
+	evictUnreferenced(0);
+}
+
+void SoundCache::shutdown()
+{
+	retainingUnreferenced = false;
+	evictUnreferenced(0);
+}
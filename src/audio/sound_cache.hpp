@@ -0,0 +1,51 @@
+/*
+ * sound_cache.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef AUDIO_SOUND_CACHE_HPP_
+#define AUDIO_SOUND_CACHE_HPP_
+#include <ciso646>
+
+#include "fgeal/fgeal.hpp"
+
+#include <string>
+
+/** A process-wide, reference-counted cache of loaded sounds, keyed by filename, so that a sound file is loaded (and decoded) only
+ *  once, no matter how many vehicles use it. Sounds that are no longer referenced are kept while they fit within a memory budget (the
+ *  least recently released being freed first), so that re-entering a race or previewing a vehicle again does not load them again.
+ *  Note that users of the same file share the same sound object (and thus its playback state).
+ *  Like the ImageCache, this must only be used from the main thread, since audio backends are not guaranteed to be thread-safe. */
+class SoundCache
+{
+	SoundCache();  // not instantiable
+
+	public:
+
+	/** Returns the sound loaded from the given file, loading it only if not already cached. Throws an exception if the file can't be
+	 *  loaded. Each call must be matched by a call to release(). Different 'instance' numbers give separate sound objects of the same
+	 *  file (each loaded on its own), which can be played simultaneously; instance 0 is the one normally shared. */
+	static fgeal::Sound* acquire(const std::string& filename, unsigned instance=0);
+
+	/** Adds a reference to the given cached sound (obtained from acquire()), which must also be matched by a call to release(). */
+	static void retain(fgeal::Sound* sound);
+
+	/** Removes a reference to the given cached sound. Sounds not obtained from acquire() are ignored. */
+	static void release(fgeal::Sound* sound);
+
+	/** Sets how much memory (in bytes, estimated from the sounds' file sizes) unreferenced sounds may take. Default is 64MB. */
+	static void setMemoryBudget(unsigned long bytes);
+
+	/** Returns the estimated memory taken by cached sounds (in bytes), referenced or not. */
+	static unsigned long getMemoryUsage();
+
+	/** Frees all cached sounds that are not referenced anymore. */
+	static void purge();
+
+	/** Frees all unreferenced sounds and stops keeping sounds once they are unreferenced. Should be called before finalizing fgeal. */
+	static void shutdown();
+};
+
+#endif /* AUDIO_SOUND_CACHE_HPP_ */
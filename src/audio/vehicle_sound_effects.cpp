@@ -0,0 +1,112 @@
+/*
+ * vehicle_sound_effects.cpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#include "vehicle_sound_effects.hpp"
+
+#include "futil/language.hpp"
+
+#include <cmath>
+
+using fgeal::Sound;
+
+// volume changes smaller than this are not passed on to the backend (not audible anyway)
+static const float VOLUME_TOLERANCE = 1/256.0;
+
+static inline void stopIfSet(Sound* sound) { if(sound != null) sound->stop(); }
+
+VehicleSoundEffects::VehicleSoundEffects()
+: sounds(), tireState(TIRE_STATE_GRIPPING), tireLoopStarted(false), offRoadLoopPlaying(false), volume(-1)
+{
+	const Sounds noSounds = { null, null, null, null, null, null };
+	sounds = noSounds;
+}
+
+void VehicleSoundEffects::setSounds(const Sounds& newSounds)
+{
+	halt();
+	sounds = newSounds;
+	volume = -1;  // unknown until set
+}
+
+Sound* VehicleSoundEffects::getTireIntro(TireState state) const
+{
+	return state == TIRE_STATE_WHEELSPIN? sounds.wheelspinIntro : state == TIRE_STATE_SIDESLIP? sounds.sideslipIntro : null;
+}
+
+Sound* VehicleSoundEffects::getTireLoop(TireState state) const
+{
+	return state == TIRE_STATE_WHEELSPIN? sounds.wheelspinLoop : state == TIRE_STATE_SIDESLIP? sounds.sideslipLoop : null;
+}
+
+void VehicleSoundEffects::update(TireState newTireState, bool runningOffRoad)
+{
+	if(newTireState != tireState)
+	{
+		// stop whatever the previous state was playing
+		stopIfSet(tireLoopStarted? getTireLoop(tireState) : getTireIntro(tireState));
+
+		// the intro is only played when starting from grip; otherwise, go straight to the loop
+		if(tireState == TIRE_STATE_GRIPPING and getTireIntro(newTireState) != null)
+		{
+			getTireIntro(newTireState)->play();
+			tireLoopStarted = false;
+		}
+		else
+		{
+			if(getTireLoop(newTireState) != null)
+				getTireLoop(newTireState)->loop();
+			tireLoopStarted = true;
+		}
+		tireState = newTireState;
+	}
+	else if(tireState != TIRE_STATE_GRIPPING and not tireLoopStarted and not getTireIntro(tireState)->isPlaying())  // intro ended, start the loop
+	{
+		if(getTireLoop(tireState) != null)
+			getTireLoop(tireState)->loop();
+		tireLoopStarted = true;
+	}
+
+	if(runningOffRoad != offRoadLoopPlaying)
+	{
+		if(sounds.offRoadLoop != null)
+		{
+			if(runningOffRoad) sounds.offRoadLoop->loop();
+			else sounds.offRoadLoop->stop();
+		}
+		offRoadLoopPlaying = runningOffRoad;
+	}
+}
+
+void VehicleSoundEffects::playCrash()
+{
+	if(sounds.crashImpact != null and not sounds.crashImpact->isPlaying())
+		sounds.crashImpact->play();
+}
+
+void VehicleSoundEffects::setVolume(float newVolume)
+{
+	if(volume >= 0 and fabs(newVolume - volume) <= VOLUME_TOLERANCE)
+		return;
+
+	Sound* const allSounds[] = { sounds.wheelspinIntro, sounds.wheelspinLoop, sounds.sideslipIntro, sounds.sideslipLoop, sounds.offRoadLoop, sounds.crashImpact };
+	for(unsigned i = 0; i < sizeof(allSounds)/sizeof(*allSounds); i++)
+		if(allSounds[i] != null)
+			allSounds[i]->setVolume(newVolume);
+
+	volume = newVolume;
+}
+
+void VehicleSoundEffects::halt()
+{
+	stopIfSet(tireLoopStarted? getTireLoop(tireState) : getTireIntro(tireState));
+	if(offRoadLoopPlaying)
+		stopIfSet(sounds.offRoadLoop);
+
+	tireState = TIRE_STATE_GRIPPING;
+	tireLoopStarted = false;
+	offRoadLoopPlaying = false;
+}
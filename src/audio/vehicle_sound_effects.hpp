@@ -0,0 +1,70 @@
+/*
+ * vehicle_sound_effects.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef AUDIO_VEHICLE_SOUND_EFFECTS_HPP_
+#define AUDIO_VEHICLE_SOUND_EFFECTS_HPP_
+#include <ciso646>
+
+#include "fgeal/fgeal.hpp"
+
+/** Plays the tire, surface and impact sound effects of a vehicle as a state machine. The caller reports the current state (i.e. which
+ *  kind of tire noise is occurring, whether running off-road) and events (i.e. crashes); backend calls are only issued on transitions.
+ *  The only sound queried while playing is a tire noise's intro, and only until it ends, to start its loop afterwards.
+ *  Each vehicle (or group of vehicles) can have its own instance of this, with its own sounds and volume. */
+class VehicleSoundEffects
+{
+	public:
+
+	enum TireState
+	{
+		TIRE_STATE_GRIPPING,  // no tire noise
+		TIRE_STATE_WHEELSPIN,  // burnout while standing or accelerating
+		TIRE_STATE_SIDESLIP  // screeching while cornering at the grip limit
+	};
+
+	/** The sounds used by the effects (not owned). Any of them may be null, in which case its effect is not played. */
+	struct Sounds
+	{
+		fgeal::Sound* wheelspinIntro, *wheelspinLoop,
+					* sideslipIntro, *sideslipLoop,
+					* offRoadLoop,
+					* crashImpact;
+	};
+
+	VehicleSoundEffects();
+
+	/** Sets the sounds to be used, halting any sound currently being played. */
+	void setSounds(const Sounds& sounds);
+
+	/** Updates the effects to the given state, issuing backend calls only if it differs from the last one (except for switching from a
+	 *  tire noise's intro to its loop). Switching directly between tire noises skips the intro of the new one. */
+	void update(TireState tireState, bool runningOffRoad);
+
+	/** Plays the crash impact sound, unless it's already playing. */
+	void playCrash();
+
+	/** Sets the volume of all sounds (only issuing backend calls if it actually changed). */
+	void setVolume(float volume);
+
+	/** Stops all sounds and resets the state. */
+	void halt();
+
+	inline TireState getTireState() const { return tireState; }
+
+	private:
+	Sounds sounds;
+	TireState tireState;
+	bool tireLoopStarted;  // whether the current tire noise's loop has started (i.e. its intro has ended)
+	bool offRoadLoopPlaying;
+	float volume;
+
+	// returns the intro and loop sounds of the given tire state (null if gripping)
+	fgeal::Sound* getTireIntro(TireState state) const;
+	fgeal::Sound* getTireLoop(TireState state) const;
+};
+
+#endif /* AUDIO_VEHICLE_SOUND_EFFECTS_HPP_ */
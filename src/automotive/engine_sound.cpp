@@ -7,12 +7,98 @@
 
 #include "engine_sound.hpp"
 
+#include "audio/sound_cache.hpp"
+
+#include "futil/language.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <cstdlib>
 #include <cmath>
 
 using std::string;
 using std::vector;
 using fgeal::Sound;
 
+// changes smaller than these are not passed on to the backend (they are not audible anyway)
+static const float VOICE_VOLUME_TOLERANCE = 1/256.0,
+				   VOICE_PLAYBACK_SPEED_TOLERANCE = 1/1024.0;
+
+// synthesized sounds are rendered in ranges whose depicted RPMs are spaced geometrically, so each one is pitched by a similar amount
+static const float SYNTHESIZED_RANGE_BASE_RPM = 1000,
+				   SYNTHESIZED_RANGE_RPM_RATIO = 1.6,
+				   SYNTHESIZED_LOOP_DURATION = 0.5,  // in seconds
+				   SYNTHESIZED_NO_LOAD_VOLUME_FACTOR = 0.55;  // the volume of synthesized sounds with no engine load, relative to full load
+
+// bump this whenever the synthesis changes, so that previously rendered sounds are not reused (revision 1 files may be truncated)
+static const unsigned SYNTHESIS_REVISION = 2;
+
+// returns the folder where rendered synthesized sounds are kept (the system's temporary folder)
+static string getSynthesizedSoundsFolder()
+{
+	const char* const variables[] = { "TMPDIR", "TEMP", "TMP" };
+	for(unsigned i = 0; i < 3; i++)
+	{
+		const char* const value = getenv(variables[i]);
+		if(value != null and *value != '\0')
+			return value;
+	}
+
+	#ifdef _WIN32
+		return ".";
+	#else
+		return "/tmp";
+	#endif
+}
+
+// returns the filename of the rendered sound of the given synthesis parameters and depicted RPM (same parameters, same file)
+static string getSynthesizedSoundFilename(const EngineSoundSynthesis::Parameters& parameters, short depictedRpm)
+{
+	const float values[] = { static_cast<float>(parameters.cylinderCount), parameters.firingIrregularity, parameters.exhaustResonance, parameters.roughness,
+							 static_cast<float>(depictedRpm), static_cast<float>(EngineSoundSynthesis::SAMPLE_RATE), static_cast<float>(SYNTHESIS_REVISION) };
+
+	// FNV-1a hash of the values
+	unsigned hash = 2166136261u;
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(values);
+	for(unsigned i = 0; i < sizeof(values); i++)
+		hash = (hash ^ bytes[i]) * 16777619u;
+
+	std::ostringstream stream;
+	stream << getSynthesizedSoundsFolder() << "/carse_engine_sound_" << std::hex << hash << ".wav";
+	return stream.str();
+}
+
+EngineSoundSimulator::EngineSoundSimulator()
+: profile(), soundData(), voiceStates(), simulatedMaximumRpm(0), volume(1)
+{}
+
+EngineSoundSimulator::EngineSoundSimulator(const EngineSoundSimulator& other)
+: profile(other.profile), soundData(other.soundData), voiceStates(other.voiceStates), simulatedMaximumRpm(other.simulatedMaximumRpm), volume(other.volume)
+{
+	for(unsigned i = 0; i < soundData.size(); i++)
+		SoundCache::retain(soundData[i]);
+}
+
+EngineSoundSimulator& EngineSoundSimulator::operator=(const EngineSoundSimulator& other)
+{
+	if(this != &other)
+	{
+		for(unsigned i = 0; i < other.soundData.size(); i++)  // retain first, in case both share sounds
+			SoundCache::retain(other.soundData[i]);
+
+		freeAssetsData();
+		profile = other.profile;
+		soundData = other.soundData;
+		voiceStates = other.voiceStates;
+		simulatedMaximumRpm = other.simulatedMaximumRpm;
+		volume = other.volume;
+	}
+	return *this;
+}
+
 EngineSoundSimulator::~EngineSoundSimulator()
 {
 	freeAssetsData();
@@ -22,25 +108,77 @@ void EngineSoundSimulator::setProfile(const EngineSoundProfile& profile, short m
 {
 	this->profile = profile;  // copies the profile (preserves the original intact)
 	this->simulatedMaximumRpm = maxRpm;
+
+	if(profile.synthesized)
+	{
+		this->profile.allowRpmPitching = true;
+		this->profile.ranges.clear();
+		for(float rpm = SYNTHESIZED_RANGE_BASE_RPM; this->profile.ranges.empty() or rpm / sqrt(SYNTHESIZED_RANGE_RPM_RATIO) < maxRpm; rpm *= SYNTHESIZED_RANGE_RPM_RATIO)
+		{
+			const short depictedRpm = EngineSoundSynthesis::getLoopableRpm(rpm) + 0.5f;
+			const EngineSoundProfile::RangeProfile range = { static_cast<short>(this->profile.ranges.empty()? 0 : depictedRpm / sqrt(SYNTHESIZED_RANGE_RPM_RATIO)),
+															 depictedRpm, getSynthesizedSoundFilename(profile.synthesisParameters, depictedRpm) };
+			this->profile.ranges.push_back(range);
+		}
+	}
+}
+
+bool EngineSoundSimulator::renderSynthesizedSounds() const
+{
+	if(profile.synthesized)
+		for(unsigned i = 0; i < profile.ranges.size(); i++)
+			if(not std::ifstream(profile.ranges[i].soundFilename.c_str()))
+			{
+				const float rpm = EngineSoundSynthesis::getLoopableRpm(profile.ranges[i].depictedRpm);
+				try { EngineSoundSynthesis::saveAsWav(EngineSoundSynthesis::renderLoop(profile.synthesisParameters, rpm, SYNTHESIZED_LOOP_DURATION), profile.ranges[i].soundFilename); }
+				catch(const std::exception& e)
+				{
+					std::cout << "warning: could not render synthesized engine sound: " << e.what() << std::endl;
+					return false;
+				}
+			}
+
+	return true;
 }
 
-void EngineSoundSimulator::loadAssetsData()
+void EngineSoundSimulator::loadAssetsData(unsigned instance)
 {
 	if(not soundData.empty())
 		this->freeAssetsData();
 
+	if(not renderSynthesizedSounds())
+	{
+		// not worth aborting the race for; the vehicle just goes without engine sound
+		this->voiceStates.clear();
+		return;
+	}
+
 	// loads sound data
 	for(unsigned i = 0; i < profile.ranges.size(); i++)
-		this->soundData.push_back(new Sound(profile.ranges[i].soundFilename));
+		this->soundData.push_back(SoundCache::acquire(profile.ranges[i].soundFilename, instance));
+
+	const VoiceState silentState = { 0, 1, false };
+	this->voiceStates.assign(soundData.size(), silentState);
+}
+
+vector<string> EngineSoundSimulator::getSoundFilenames() const
+{
+	vector<string> filenames;
+	for(unsigned i = 0; i < profile.ranges.size(); i++)
+		if(not profile.synthesized or std::ifstream(profile.ranges[i].soundFilename.c_str()))
+			filenames.push_back(profile.ranges[i].soundFilename);
+
+	return filenames;
 }
 
 void EngineSoundSimulator::freeAssetsData()
 {
 	// cleanup
 	for(unsigned i = 0; i < soundData.size(); i++)
-		delete soundData[i];
+		SoundCache::release(soundData[i]);
 
 	this->soundData.clear();
+	this->voiceStates.clear();
 }
 
 unsigned EngineSoundSimulator::getRangeIndex(float rpm)
@@ -64,7 +202,7 @@ void EngineSoundSimulator::play()
 		update(profile.ranges[0].startRpm+1);  //XXX this +1 may be unneccessary
 }
 
-void EngineSoundSimulator::update(float currentRpm)
+void EngineSoundSimulator::update(float currentRpm, float load, float pitchFactor)
 {
 	const unsigned soundCount = soundData.size();
 	if(soundCount > 0 and currentRpm > 0) // its no use if there is no engine sound or rpm is too low
@@ -73,42 +211,25 @@ void EngineSoundSimulator::update(float currentRpm)
 		const unsigned currentRangeIndex = this->getRangeIndex(currentRpm);
 
 		// some aliases
-		Sound& currentSound = *soundData[currentRangeIndex];
-		const float currentRangeLowerRpm = profile.ranges[currentRangeIndex].startRpm,
+		const float volume = profile.synthesized? this->volume * (SYNTHESIZED_NO_LOAD_VOLUME_FACTOR + (1 - SYNTHESIZED_NO_LOAD_VOLUME_FACTOR) * load) : this->volume,
+					currentRangeLowerRpm = profile.ranges[currentRangeIndex].startRpm,
 					currentRangeUpperRpm = currentRangeIndex + 1 < soundCount? profile.ranges[currentRangeIndex + 1].startRpm : simulatedMaximumRpm,
-					currentRangeSize = currentRangeUpperRpm - currentRangeLowerRpm,
-					currentRangeSoundDepictedRpm = profile.ranges[currentRangeIndex].depictedRpm;
-
-		currentSound.setVolume(volume);
-
-		if(profile.allowRpmPitching)
-			currentSound.setPlaybackSpeed(currentRpm/currentRangeSoundDepictedRpm, true);
+					currentRangeSize = currentRangeUpperRpm - currentRangeLowerRpm;
 
-		if(not currentSound.isPlaying())
-			currentSound.loop();
-
-		for(unsigned i = 0; i < soundData.size(); i++)
+		for(unsigned i = 0; i < soundCount; i++)
 		{
-			// some aliases
-			Sound& rangeSound = *soundData[i];
-			const short rangeSoundDepictedRpm = profile.ranges[i].depictedRpm;
+			const float rangePlaybackSpeed = profile.allowRpmPitching? pitchFactor * currentRpm/profile.ranges[i].depictedRpm : 1;
 
 			// current range
 			if(i == currentRangeIndex)
-				continue;  // already handled
+				applyVoiceState(i, volume, rangePlaybackSpeed, true);
 
 			// preceding range
 			else if(i + 1 == currentRangeIndex                                      // this range is preceding the current range
 					and currentRpm - currentRangeLowerRpm < 0.25*currentRangeSize)  // current RPM is within 0-25% of current range
 			{
 //				snd.setVolume(1.0 - 4*(currentRpm - lowerRpmCurrent)/rangeSizeCurrent);  // linear fade out
-				rangeSound.setVolume(volume * sqrt(1-16*pow((currentRpm - currentRangeLowerRpm)/currentRangeSize, 2)));  // quadratic fade out
-
-				if(profile.allowRpmPitching)
-					rangeSound.setPlaybackSpeed(currentRpm/rangeSoundDepictedRpm, true);
-
-				if(not rangeSound.isPlaying())
-					rangeSound.loop();
+				applyVoiceState(i, volume * sqrt(1-16*pow((currentRpm - currentRangeLowerRpm)/currentRangeSize, 2)), rangePlaybackSpeed, true);  // quadratic fade out
 			}
 
 			// succeeding range
@@ -116,24 +237,55 @@ void EngineSoundSimulator::update(float currentRpm)
 					and currentRpm - currentRangeLowerRpm > 0.75*currentRangeSize)  // current RPM is within 75-100% of current range
 			{
 //				snd.setVolume(-3.0 + 4*(currentRpm - lowerRpmCurrent)/rangeSizeCurrent);  // linear fade in
-				rangeSound.setVolume(volume * sqrt(1-pow(4*((currentRpm - currentRangeLowerRpm)/currentRangeSize)-4, 2)));  // quadratic fade in
+				applyVoiceState(i, volume * sqrt(1-pow(4*((currentRpm - currentRangeLowerRpm)/currentRangeSize)-4, 2)), rangePlaybackSpeed, true);  // quadratic fade in
+			}
 
-				if(profile.allowRpmPitching)
-					rangeSound.setPlaybackSpeed(currentRpm/rangeSoundDepictedRpm, true);
+			else applyVoiceState(i, 0, rangePlaybackSpeed, false);
+		}
+	}
+}
 
-				if(not rangeSound.isPlaying())
-					rangeSound.loop();
-			}
+void EngineSoundSimulator::applyVoiceState(unsigned index, float volume, float playbackSpeed, bool looping)
+{
+	Sound& sound = *soundData[index];
+	VoiceState& state = voiceStates[index];
 
-			else rangeSound.stop();
+	if(not looping)
+	{
+		if(state.looping)  // silent ranges are only stopped once, then left alone
+		{
+			sound.stop();
+			state.looping = false;
 		}
+		return;
+	}
+
+	if(not state.looping or fabs(volume - state.volume) > VOICE_VOLUME_TOLERANCE)
+	{
+		sound.setVolume(volume);
+		state.volume = volume;
+	}
+
+	if(profile.allowRpmPitching and (not state.looping or fabs(playbackSpeed - state.playbackSpeed) > VOICE_PLAYBACK_SPEED_TOLERANCE))
+	{
+		sound.setPlaybackSpeed(playbackSpeed, true);
+		state.playbackSpeed = playbackSpeed;
+	}
+
+	if(not state.looping)
+	{
+		sound.loop();
+		state.looping = true;
 	}
 }
 
 void EngineSoundSimulator::halt()
 {
 	for(unsigned i = 0; i < soundData.size(); i++)
+	{
 		soundData[i]->stop();
+		voiceStates[i].looping = false;
+	}
 }
 
 void EngineSoundSimulator::setVolume(float vol)
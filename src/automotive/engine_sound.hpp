@@ -9,6 +9,8 @@
 #define AUTOMOTIVE_ENGINE_SOUND_HPP_
 #include <ciso646>
 
+#include "engine_sound_synthesis.hpp"
+
 #include "fgeal/fgeal.hpp"
 
 #include <vector>
@@ -28,6 +30,14 @@ struct EngineSoundProfile
 
 	// information about each sound for each range
 	std::vector<RangeProfile> ranges;
+
+	// if true, the sounds of each range are synthesized (with the parameters below) instead of loaded from files; ranges are then set by the simulator
+	bool synthesized;
+
+	// the parameters of the synthesized sounds (only used if 'synthesized' is true)
+	EngineSoundSynthesis::Parameters synthesisParameters;
+
+	EngineSoundProfile() : allowRpmPitching(true), ranges(), synthesized(false), synthesisParameters() {}
 };
 
 class EngineSoundSimulator
@@ -38,6 +48,16 @@ class EngineSoundSimulator
 	// a set of actual sound data. each index in this corresponds to each index on the profile's ranges
 	std::vector<fgeal::Sound*> soundData;
 
+	// the state last applied to a sound of the sound data
+	struct VoiceState
+	{
+		float volume, playbackSpeed;
+		bool looping;
+	};
+
+	// the state last applied to each sound (same indexes as the sound data), so that the backend is only called when a state changes
+	std::vector<VoiceState> voiceStates;
+
 	// the maximum RPM expected to be simulated. this must be the maximum value expected to be passed to EngineSoundSimulator::updateSound().
 	short simulatedMaximumRpm;
 
@@ -47,14 +67,32 @@ class EngineSoundSimulator
 	//calculates engine sound pitch for given RPM and max RPM
 	float calculatePitch(float rpmDiff);
 
+	// applies the given state to the sound of the given index, issuing backend calls only for what differs from its last applied state
+	void applyVoiceState(unsigned index, float volume, float playbackSpeed, bool looping);
+
 	public:
+	EngineSoundSimulator();
+
+	// copies share the same sound data (each copy holds its own reference to it, see SoundCache)
+	EngineSoundSimulator(const EngineSoundSimulator&);
+	EngineSoundSimulator& operator=(const EngineSoundSimulator&);
+
 	// changes the current profile.
 	void setProfile(const EngineSoundProfile& profile, short simulatedMaximumRpm);
 
-	// effectively loads sound data from files, as specified in the profile (any previously loaded data will be freed if it isn't shared)
-	void loadAssetsData();
+	// effectively loads sound data from files (through the SoundCache, so files already loaded are not loaded again), as specified in the profile (any previously loaded data is released)
+	// simulators loaded with different 'instance' numbers get separate sound objects (see SoundCache::acquire()), so they can play at the same time
+	void loadAssetsData(unsigned instance=0);
+
+	// renders the profile's synthesized sounds not yet rendered (by another simulator or on a previous run), if any; returns false if rendering failed
+	// loadAssetsData() does it first, but it may be done ahead of time (i.e. while loading a race), so that loadAssetsData() doesn't take long
+	bool renderSynthesizedSounds() const;
+
+	// returns the sound files that loadAssetsData() would load, except synthesized sounds not yet rendered (which loadAssetsData() renders first)
+	// useful to load them ahead of time (i.e. in time slices, see AssetLoadingQueue), so that loadAssetsData() doesn't block
+	std::vector<std::string> getSoundFilenames() const;
 
-	// free all sound data loaded by this simulator (if not shared by other objects)
+	// releases all sound data loaded by this simulator (it's freed by the SoundCache when not used by other objects anymore)
 	void freeAssetsData();
 
 	// gets the range index for the given RPM value
@@ -67,7 +105,9 @@ class EngineSoundSimulator
 	void play();
 
 	// updates the engine sound simulation to play the desired engine RPM. if no sound is being played, the simulator begins playing.
-	void update(float currentRpm);
+	// 'load' is the engine load (i.e. throttle position), in the range [0,1]; only synthesized sounds are affected by it.
+	// 'pitchFactor' multiplies the playback speed of all sounds (i.e. for Doppler shift); it has no effect if the profile doesn't allow RPM pitching.
+	void update(float currentRpm, float load=1, float pitchFactor=1);
 
 	// stops all currently playing sounds from this simulator
 	void halt();
@@ -0,0 +1,168 @@
+/*
+ * engine_sound_synthesis.cpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#include "engine_sound_synthesis.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+
+#include <cstdio>
+#include <cmath>
+
+#ifdef _WIN32
+	#include <process.h>
+	#define getpid _getpid
+#else
+	#include <unistd.h>
+#endif
+
+using std::vector;
+using std::string;
+
+const unsigned EngineSoundSynthesis::SAMPLE_RATE = 22050;
+
+static const float PULSE_DECAY_CYCLES = 3,  // how many resonance cycles it takes for a pulse to decay to ~37% of its amplitude
+				   PULSE_DURATION_DECAYS = 6,  // pulses are cut after this many decay time constants
+				   PULSE_THUMP_FACTOR = 0.6,  // the amplitude of the low-frequency "thump" of each pulse, relative to its resonance
+				   NOISE_SMOOTHING_FACTOR = 0.35,  // the coefficient of the low-pass filter applied to the combustion noise
+				   PEAK_AMPLITUDE = 0.8 * 32767;
+
+static const double TWO_PI = 6.283185307179586;
+
+// a simple, deterministic pseudo-random generator (so that renders are reproducible), returning values in [-0.5, 0.5)
+struct PseudoRandom
+{
+	unsigned state;
+	PseudoRandom(unsigned seed) : state(seed * 2654435761u + 1) {}
+	float next() { state = state * 1664525u + 1013904223u; return (state >> 8) / 16777216.0f - 0.5f; }
+};
+
+// the samples spanned by a 4-stroke engine cycle (two revolutions) at the given RPM
+static double getCycleSampleCount(float rpm)
+{
+	return 120.0 * EngineSoundSynthesis::SAMPLE_RATE / rpm;
+}
+
+float EngineSoundSynthesis::getLoopableRpm(float rpm)
+{
+	const double cycleSampleCount = std::max(1.0, floor(getCycleSampleCount(rpm) + 0.5));
+	return 120.0 * SAMPLE_RATE / cycleSampleCount;
+}
+
+vector<short> EngineSoundSynthesis::renderLoop(const Parameters& parameters, float rpm, float minimumDuration)
+{
+	const unsigned cylinderCount = std::max(1u, parameters.cylinderCount),
+				   cycleSampleCount = floor(getCycleSampleCount(rpm) + 0.5),
+				   cycleCount = std::max(1u, static_cast<unsigned>(ceil(minimumDuration * SAMPLE_RATE / cycleSampleCount))),
+				   sampleCount = cycleCount * cycleSampleCount;
+
+	const double resonanceFrequency = parameters.exhaustResonance / SAMPLE_RATE,  // in cycles per sample
+				 decayRate = resonanceFrequency / PULSE_DECAY_CYCLES,  // per sample
+				 thumpFrequency = 0.5 * rpm * cylinderCount / 120.0 / SAMPLE_RATE;  // half the firing frequency, in cycles per sample
+
+	const unsigned pulseSampleCount = std::min<unsigned>(sampleCount, PULSE_DURATION_DECAYS / decayRate);
+
+	// the phase (within the cycle) of each cylinder's firing; uneven firing displaces each of them by a fixed, pseudo-random amount
+	vector<double> firingPhase(cylinderCount);
+	PseudoRandom firingOrderRandom(cylinderCount);
+	for(unsigned c = 0; c < cylinderCount; c++)
+		firingPhase[c] = (c + (c > 0? parameters.firingIrregularity * firingOrderRandom.next() : 0)) / cylinderCount;
+
+	// each firing adds its pulse to the buffer, wrapping around its end, so the loop is seamless
+	vector<double> pulses(sampleCount, 0), noise(sampleCount, 0);
+	PseudoRandom combustionRandom(cylinderCount * 31 + cycleCount);
+	for(unsigned cycle = 0; cycle < cycleCount; cycle++)
+		for(unsigned c = 0; c < cylinderCount; c++)
+		{
+			const double firingTime = (cycle + firingPhase[c]) * cycleSampleCount;
+			const float amplitude = 1 + parameters.roughness * combustionRandom.next();
+			const unsigned firstSample = ceil(firingTime);
+			for(unsigned i = 0; i < pulseSampleCount; i++)
+			{
+				const double t = firstSample + i - firingTime, envelope = amplitude * exp(-decayRate * t);
+				const unsigned index = (firstSample + i) % sampleCount;
+				pulses[index] += envelope * (sin(TWO_PI * resonanceFrequency * t) + PULSE_THUMP_FACTOR * sin(TWO_PI * thumpFrequency * t));
+				noise[index] += envelope * parameters.roughness * combustionRandom.next();
+			}
+		}
+
+	// low-pass the noise circularly (the first pass only settles the filter's state, so there is no discontinuity when looping)
+	double filtered = 0;
+	for(unsigned pass = 0; pass < 2; pass++)
+		for(unsigned i = 0; i < sampleCount; i++)
+		{
+			filtered += NOISE_SMOOTHING_FACTOR * (noise[i] - filtered);
+			if(pass == 1)
+				pulses[i] += filtered;
+		}
+
+	// remove any DC offset and normalize
+	double mean = 0, peak = 0;
+	for(unsigned i = 0; i < sampleCount; i++)
+		mean += pulses[i] / sampleCount;
+	for(unsigned i = 0; i < sampleCount; i++)
+		peak = std::max(peak, fabs(pulses[i] - mean));
+
+	vector<short> samples(sampleCount);
+	for(unsigned i = 0; i < sampleCount; i++)
+		samples[i] = peak > 0? static_cast<short>((pulses[i] - mean) / peak * PEAK_AMPLITUDE) : 0;
+
+	return samples;
+}
+
+// writes the given value as little-endian, with the given number of bytes
+static void writeLittleEndian(std::ofstream& stream, unsigned value, unsigned byteCount)
+{
+	for(unsigned i = 0; i < byteCount; i++)
+		stream.put(static_cast<char>((value >> (8*i)) & 0xFF));
+}
+
+void EngineSoundSynthesis::saveAsWav(const vector<short>& samples, const string& filename)
+{
+	// written under a temporary name (unique to this process) and then renamed, so that an interrupted write never leaves a truncated file
+	std::ostringstream temporaryFilenameStream;
+	temporaryFilenameStream << filename << ".part" << getpid();
+	const string temporaryFilename = temporaryFilenameStream.str();
+
+	std::ofstream stream(temporaryFilename.c_str(), std::ios::binary);
+	if(not stream)
+		throw std::runtime_error("could not open " + temporaryFilename + " for writing");
+
+	const unsigned dataSize = samples.size() * 2;
+	stream.write("RIFF", 4);
+	writeLittleEndian(stream, 36 + dataSize, 4);
+	stream.write("WAVE", 4);
+	stream.write("fmt ", 4);
+	writeLittleEndian(stream, 16, 4);  // format chunk size
+	writeLittleEndian(stream, 1, 2);  // PCM
+	writeLittleEndian(stream, 1, 2);  // mono
+	writeLittleEndian(stream, SAMPLE_RATE, 4);
+	writeLittleEndian(stream, SAMPLE_RATE * 2, 4);  // byte rate
+	writeLittleEndian(stream, 2, 2);  // block align
+	writeLittleEndian(stream, 16, 2);  // bits per sample
+	stream.write("data", 4);
+	writeLittleEndian(stream, dataSize, 4);
+	for(unsigned i = 0; i < samples.size(); i++)
+		writeLittleEndian(stream, static_cast<unsigned short>(samples[i]), 2);
+
+	stream.close();
+	if(not stream)
+	{
+		std::remove(temporaryFilename.c_str());
+		throw std::runtime_error("could not write " + temporaryFilename);
+	}
+
+	// renaming fails on some systems if the file already exists, which is fine if it was just saved by another process
+	if(std::rename(temporaryFilename.c_str(), filename.c_str()) != 0)
+	{
+		std::remove(temporaryFilename.c_str());
+		if(not std::ifstream(filename.c_str()))
+			throw std::runtime_error("could not rename " + temporaryFilename + " to " + filename);
+	}
+}
@@ -0,0 +1,46 @@
+/*
+ * engine_sound_synthesis.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef AUTOMOTIVE_ENGINE_SOUND_SYNTHESIS_HPP_
+#define AUTOMOTIVE_ENGINE_SOUND_SYNTHESIS_HPP_
+#include <ciso646>
+
+#include <vector>
+#include <string>
+
+/** Procedural engine sound synthesis. An engine note is rendered as a train of exhaust pulses, one per cylinder firing, each being a
+ *  decaying oscillation at the exhaust's resonance frequency, plus some combustion noise. Rendered loops are seamless (they span a whole
+ *  number of engine cycles), so that they can be looped and pitched like recorded engine sounds. */
+struct EngineSoundSynthesis
+{
+	/** The parameters of a synthesized engine sound. */
+	struct Parameters
+	{
+		unsigned cylinderCount;
+		float firingIrregularity;  // how uneven the intervals between firings are (0 is evenly spaced, 1 is the most uneven, i.e. like a crossplane V8)
+		float exhaustResonance;  // the resonance frequency of the exhaust, in Hz
+		float roughness;  // the amount of combustion noise and variation between firings, in the range [0, 1]
+
+		Parameters() : cylinderCount(4), firingIrregularity(0), exhaustResonance(180), roughness(0.25) {}
+	};
+
+	/** The sample rate of rendered sounds. */
+	static const unsigned SAMPLE_RATE;
+
+	/** Returns the RPM closest to the given one that a loop can depict seamlessly (i.e. whose engine cycle spans a whole number of samples). */
+	static float getLoopableRpm(float rpm);
+
+	/** Renders a seamless loop (of at least the given duration, in seconds) depicting an engine with the given parameters at the given RPM,
+	 *  which must be a loopable RPM (see getLoopableRpm()). Samples are 16-bit, mono, at SAMPLE_RATE. */
+	static std::vector<short> renderLoop(const Parameters& parameters, float rpm, float minimumDuration);
+
+	/** Saves the given samples (16-bit, mono, at SAMPLE_RATE) as a WAV file. The file is written under a temporary name and then renamed,
+	 *  so it either shows up complete or not at all. Throws an exception if the file could not be written. */
+	static void saveAsWav(const std::vector<short>& samples, const std::string& filename);
+};
+
+#endif /* AUTOMOTIVE_ENGINE_SOUND_SYNTHESIS_HPP_ */
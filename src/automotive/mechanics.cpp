@@ -5,6 +5,8 @@
  *      Author: carlosfaruolo
  */
 
+#include "strict_floating_point.hpp"  // must come first
+
 #include "mechanics.hpp"
 
 #include "futil/math_constants.h"
@@ -26,14 +28,15 @@
 #define DOWNFORCE_ARBITRATY_ADJUST 0.5
 #define BRAKE_PAD_TORQUE_ARBITRARY_ADJUST 7500
 #define ROLLING_RESISTANCE_TORQUE_ARBITRARY_ADJUST 0.25
+#define WHEEL_ANGULAR_ACCELERATION_ARBITRARY_ADJUST 0.002
 
 const float Mechanics::GRAVITY_ACCELERATION = 9.8066, // standard gravity (actual value varies with altitude, from 9.7639 to 9.8337)
 			Mechanics::RAD_TO_RPM = (30.0/M_PI),  // 60/2pi conversion to RPM
 			Mechanics::AIR_DENSITY = 1.2041;  // air density at sea level, 20ºC (68ºF) (but actually varies significantly with altitude, temperature and humidity)
 
 Mechanics::Mechanics(const Engine& eng, VehicleType type, float dragArea, float liftArea)
-: simulationType(SIMULATION_TYPE_WHEEL_LOAD_CAP), vehicleType(type), engine(eng),
-  automaticShiftingEnabled(), automaticShiftingLastTime(0),
+: simulationType(SIMULATION_TYPE_WHEEL_LOAD_CAP), integrationMethod(INTEGRATION_METHOD_EULER), vehicleType(type), engine(eng),
+  automaticShiftingEnabled(), automaticShiftingLastTime(0), automaticShiftingScheduleEnabled(true), shiftSchedule(),
   mass(1250), tireRadius(650), wheelCount(type == TYPE_CAR? 4 : type == TYPE_BIKE? 2 : 1),
   speed(), acceleration(),
   centerOfGravityHeight(500), wheelbase(1000), weightDistribution(0.5),
@@ -46,6 +49,7 @@ Mechanics::Mechanics(const Engine& eng, VehicleType type, float dragArea, float
   engineLocation(ENGINE_LOCATION_ON_FRONT),
   rollingResistanceForce(), airDragForce(), brakingForce(), slopePullForce(), downforce(),
   arbitraryForceFactor(1.0),
+  slopeAngleSine(), slopeAngleSineArgument(),
   slipRatio(), differentialSlipRatio()
 {}
 
@@ -72,58 +76,20 @@ void Mechanics::updatePowertrain(float delta)
 {
 	if(automaticShiftingEnabled and slipRatio < 0.1 and automaticShiftingLastTime > 1.0)
 	{
-		const int nextGear = engine.gear+1, prevGear = engine.gear-1;
-		bool shifted = false, stagedThrottle = false;
-		if(engine.throttlePosition == 0)
-		{
-			engine.throttlePosition = 1.0;
-			stagedThrottle = true;
-		}
-		if(nextGear-1 < engine.gearCount)
-		{
-			const float nextGearRpm = wheelAngularSpeed * engine.gearRatio[nextGear-1] * engine.differentialRatio * RAD_TO_RPM;
-			if(nextGearRpm > 0)
-			{
-				const float nextGearDriveTorque = engine.getTorqueAt(nextGearRpm) * engine.gearRatio[nextGear-1] * engine.differentialRatio * engine.transmissionEfficiency;
-				if(engine.getDriveTorque() < nextGearDriveTorque)
-				{
-					if(stagedThrottle)
-						engine.throttlePosition = 0;
-					shiftGear(nextGear);
-					automaticShiftingLastTime = 0;
-					shifted = true;
-				}
-			}
-		}
-		if(not shifted and prevGear > 0)
-		{
-			const float prevGearRpm = wheelAngularSpeed * engine.gearRatio[prevGear-1] * engine.differentialRatio * RAD_TO_RPM;
-			if(prevGearRpm < engine.maxRpm)
-			{
-				const float prevGearDriveTorque = engine.getTorqueAt(prevGearRpm) * engine.gearRatio[prevGear-1] * engine.differentialRatio * engine.transmissionEfficiency;
-				if(engine.getDriveTorque() < 0.9*prevGearDriveTorque)
-				{
-					if(stagedThrottle)
-						engine.throttlePosition = 0;
-					shiftGear(prevGear);
-					automaticShiftingLastTime = 0;
-					shifted = true;
-				}
-			}
-		}
-		if(not shifted and stagedThrottle)
-			engine.throttlePosition = 0;
+		if(automaticShiftingScheduleEnabled and not shiftSchedule.empty() and engine.gear != 0)
+			updateAutomaticShiftingBySchedule();
+		else
+			updateAutomaticShiftingByTorqueComparison();
 	}
 	automaticShiftingLastTime += delta;
 
-	const float weight = mass * GRAVITY_ACCELERATION;
-	brakingForce = brakePedalPosition * tireFrictionFactor * weight * sgn(speed);  // a multiplier here could be added for stronger and easier braking
-	rollingResistanceForce = rollingResistanceFactor * weight * sgn(speed);  // rolling friction is independant on wheel count since the weight will be divided between them
-	slopePullForce = weight * sin(slopeAngle);
-	airDragForce = 0.5 * airDragFactor * pow2(speed) * AIR_DRAG_ARBITRARY_ADJUST;
+	if(integrationMethod == INTEGRATION_METHOD_RK2 or integrationMethod == INTEGRATION_METHOD_RK4)
+	{
+		updateByRungeKutta(delta, integrationMethod == INTEGRATION_METHOD_RK4);
+		return;
+	}
 
-	// update downforce
-	downforce = 0.5 * downforceFactor * pow2(speed) * DOWNFORCE_ARBITRATY_ADJUST;
+	updateResistanceForces();
 
 	// update drivetrain
 	if(simulationType == SIMULATION_TYPE_PACEJKA_BASED)
@@ -131,20 +97,8 @@ void Mechanics::updatePowertrain(float delta)
 	else
 		updateBySimplifiedScheme(delta);
 
-	// compute total net force
-	float totalForce = (
-		// drive force is ready to be get AFTER updating drivetrain
-		arbitraryForceFactor*getDriveForce()
-
-		// discounts for slope gravity pull and air drag friction
-		- (slopePullForce + airDragForce)
-
-		// pacejka scheme already accounts for braking force and rolling resistance force
-		- (simulationType != SIMULATION_TYPE_PACEJKA_BASED? (brakingForce + rollingResistanceForce) : 0)
-	);
-
 	// update acceleration
-	acceleration = totalForce/mass;  // divide forces by mass
+	acceleration = getNetForce()/mass;  // divide forces by mass
 
 	// update speed
 	speed += delta*acceleration;
@@ -207,6 +161,339 @@ float Mechanics::getDrivenWheelsWeightLoad()
 	return weightLoad;
 }
 
+float Mechanics::getMaximumDriveForce(float speed) const
+{
+	const float wheelAngularSpeed = speed/tireRadius;
+	float maximumDriveForce = 0;
+	for(int g = 0; g < engine.gearCount; g++)
+	{
+		const float totalRatio = engine.gearRatio[g] * engine.differentialRatio,
+					rpm = std::max(wheelAngularSpeed * totalRatio * RAD_TO_RPM, engine.minRpm);  // below idle, assume the clutch is slipping
+
+		if(rpm > engine.maxRpm)  // gear too short for this speed
+			continue;
+
+		const float driveForce = engine.maximumTorque * engine.torqueCurveProfile.getTorqueFactor(rpm) * totalRatio * engine.transmissionEfficiency / tireRadius;
+		if(driveForce > maximumDriveForce)
+			maximumDriveForce = driveForce;
+	}
+
+	if(simulationType != SIMULATION_TYPE_SLIPLESS)
+	{
+		const float weightLoad = mass*GRAVITY_ACCELERATION - getDownforce(speed),
+					drivenWheelsWeightLoad = drivenWheelsType == DRIVEN_WHEELS_ALL? weightLoad
+											: drivenWheelsType == DRIVEN_WHEELS_ON_REAR? weightDistribution*weightLoad
+											: (1-weightDistribution)*weightLoad;
+
+		maximumDriveForce = std::min(maximumDriveForce, drivenWheelsWeightLoad * tireFrictionFactor);
+	}
+
+	return maximumDriveForce;
+}
+
+// ------------------------------------------------------------------------------------------------
+// ---- INTEGRATION -------------------------------------------------------------------------------
+
+/*
+ * Maximum time steps were chosen by comparing 0-100km/h and quarter mile times, top speed and coast/braking speed against
+ * a reference solution (RK4 with 0.1ms steps), for several power-to-weight ratios, accepting errors up to about twice the
+ * ones from the original scheme (explicit euler with 0.01s steps). Explicit euler diverges at 0.04s because of the stiff
+ * engine-drivetrain synchronization, which the semi-implicit method solves implicitly.
+ * The pacejka scheme is also bound by the stiffness of the slip ratio equation, which only the semi-implicit method solves
+ * implicitly (see updateSlipRatioImplicitly()), so the other methods there can't go beyond the original step.
+ */
+
+Mechanics::IntegrationMethod Mechanics::getDefaultIntegrationMethod(SimulationType type)
+{
+	switch(type)
+	{
+		default:
+		case SIMULATION_TYPE_SLIPLESS:
+		case SIMULATION_TYPE_WHEEL_LOAD_CAP:
+		case SIMULATION_TYPE_PACEJKA_BASED:		return INTEGRATION_METHOD_SEMI_IMPLICIT_EULER;
+	}
+}
+
+float Mechanics::getMaximumTimeStep(SimulationType type, IntegrationMethod method)
+{
+	if(type == SIMULATION_TYPE_PACEJKA_BASED)
+		return method == INTEGRATION_METHOD_SEMI_IMPLICIT_EULER? 0.02 : 0.01;
+
+	switch(method)
+	{
+		default:
+		case INTEGRATION_METHOD_EULER:					return 0.01;
+		case INTEGRATION_METHOD_SEMI_IMPLICIT_EULER:	return 0.02;
+		case INTEGRATION_METHOD_RK2:					return 0.02;
+		case INTEGRATION_METHOD_RK4:					return 0.02;  // larger steps mistime gear shifts enough to lose accuracy
+	}
+}
+
+void Mechanics::updateResistanceForces()
+{
+	const float weight = mass * GRAVITY_ACCELERATION;
+	brakingForce = brakePedalPosition * tireFrictionFactor * weight * sgn(speed);  // a multiplier here could be added for stronger and easier braking
+	rollingResistanceForce = rollingResistanceFactor * weight * sgn(speed);  // rolling friction is independant on wheel count since the weight will be divided between them
+	if(slopeAngle != slopeAngleSineArgument)
+	{
+		slopeAngleSineArgument = slopeAngle;
+		slopeAngleSine = sin(slopeAngle);
+	}
+	slopePullForce = weight * slopeAngleSine;
+	airDragForce = getAirDragForce(speed);
+
+	// update downforce
+	downforce = getDownforce(speed);
+}
+
+float Mechanics::getAirDragForce(float speed) const
+{
+	return 0.5 * airDragFactor * pow2(speed) * AIR_DRAG_ARBITRARY_ADJUST;
+}
+
+float Mechanics::getDownforce(float speed) const
+{
+	return 0.5 * downforceFactor * pow2(speed) * DOWNFORCE_ARBITRATY_ADJUST;
+}
+
+float Mechanics::getNetForce()
+{
+	return (
+		// drive force is ready to be get AFTER updating drivetrain
+		arbitraryForceFactor*getDriveForce()
+
+		// discounts for slope gravity pull and air drag friction
+		- (slopePullForce + airDragForce)
+
+		// pacejka scheme already accounts for braking force and rolling resistance force
+		- (simulationType != SIMULATION_TYPE_PACEJKA_BASED? (brakingForce + rollingResistanceForce) : 0)
+	);
+}
+
+// Computes the time derivative of the powertrain state, as given by the current values of speed, wheelAngularSpeed, engine.rpm and differentialSlipRatio.
+// As a side effect, the forces and slip ratio are updated to reflect the current state.
+void Mechanics::computeStateDerivative(State& derivative)
+{
+	updateResistanceForces();
+
+	if(simulationType == SIMULATION_TYPE_PACEJKA_BASED)
+	{
+		derivative.differentialSlipRatio = getDifferentialSlipRatioRate();
+		updateSlipRatioFromDifferential(derivative.differentialSlipRatio);
+		derivative.wheelAngularSpeed = getWheelAngularAcceleration();
+	}
+	else
+	{
+		wheelAngularSpeed = speed/tireRadius;  // this formula assumes no wheel slipping.
+		derivative.wheelAngularSpeed = 0;
+		derivative.differentialSlipRatio = 0;
+	}
+
+	derivative.rpm = engine.getRpmRate(wheelAngularSpeed);
+	derivative.speed = getNetForce()/mass;
+}
+
+// Sets the powertrain state as the given initial state advanced by 'delta' seconds along the given derivative.
+void Mechanics::setState(const State& initial, const State& derivative, float delta)
+{
+	speed = initial.speed + delta * derivative.speed;
+	wheelAngularSpeed = initial.wheelAngularSpeed + delta * derivative.wheelAngularSpeed;
+	differentialSlipRatio = initial.differentialSlipRatio + delta * derivative.differentialSlipRatio;
+	engine.rpm = initial.rpm + delta * derivative.rpm;
+	engine.clampRpm();
+}
+
+void Mechanics::updateByRungeKutta(float delta, bool fourthOrder)
+{
+	const State initial = { speed, wheelAngularSpeed, engine.rpm, differentialSlipRatio };
+	State k1, k2, k3, k4, weighted;
+
+	computeStateDerivative(k1);
+	setState(initial, k1, 0.5f*delta);
+	computeStateDerivative(k2);
+
+	if(fourthOrder)
+	{
+		setState(initial, k2, 0.5f*delta);
+		computeStateDerivative(k3);
+		setState(initial, k3, delta);
+		computeStateDerivative(k4);
+
+		weighted.speed = (k1.speed + 2*(k2.speed + k3.speed) + k4.speed)/6;
+		weighted.wheelAngularSpeed = (k1.wheelAngularSpeed + 2*(k2.wheelAngularSpeed + k3.wheelAngularSpeed) + k4.wheelAngularSpeed)/6;
+		weighted.rpm = (k1.rpm + 2*(k2.rpm + k3.rpm) + k4.rpm)/6;
+		weighted.differentialSlipRatio = (k1.differentialSlipRatio + 2*(k2.differentialSlipRatio + k3.differentialSlipRatio) + k4.differentialSlipRatio)/6;
+	}
+	else
+		weighted = k2;
+
+	setState(initial, weighted, delta);
+	acceleration = weighted.speed;
+
+	// leave forces, slip ratio and wheel angular speed consistent with the new state
+	updateResistanceForces();
+	if(simulationType == SIMULATION_TYPE_PACEJKA_BASED)
+		updateSlipRatioFromDifferential(getDifferentialSlipRatioRate());
+	else
+		wheelAngularSpeed = speed/tireRadius;
+}
+
+// ------------------------------------------------------------------------------------------------
+// ---- AUTOMATIC SHIFTING ------------------------------------------------------------------------
+
+void Mechanics::updateAutomaticShiftingByTorqueComparison()
+{
+	const int nextGear = engine.gear+1, prevGear = engine.gear-1;
+	bool shifted = false, stagedThrottle = false;
+	if(engine.throttlePosition == 0)
+	{
+		engine.throttlePosition = 1.0;
+		stagedThrottle = true;
+	}
+	if(nextGear-1 < engine.gearCount)
+	{
+		const float nextGearRpm = wheelAngularSpeed * engine.gearRatio[nextGear-1] * engine.differentialRatio * RAD_TO_RPM;
+		if(nextGearRpm > 0)
+		{
+			const float nextGearDriveTorque = engine.getTorqueAt(nextGearRpm) * engine.gearRatio[nextGear-1] * engine.differentialRatio * engine.transmissionEfficiency;
+			if(engine.getDriveTorque() < nextGearDriveTorque)
+			{
+				if(stagedThrottle)
+					engine.throttlePosition = 0;
+				shiftGear(nextGear);
+				automaticShiftingLastTime = 0;
+				shifted = true;
+			}
+		}
+	}
+	if(not shifted and prevGear > 0)
+	{
+		const float prevGearRpm = wheelAngularSpeed * engine.gearRatio[prevGear-1] * engine.differentialRatio * RAD_TO_RPM;
+		if(prevGearRpm < engine.maxRpm)
+		{
+			const float prevGearDriveTorque = engine.getTorqueAt(prevGearRpm) * engine.gearRatio[prevGear-1] * engine.differentialRatio * engine.transmissionEfficiency;
+			if(engine.getDriveTorque() < 0.9*prevGearDriveTorque)
+			{
+				if(stagedThrottle)
+					engine.throttlePosition = 0;
+				shiftGear(prevGear);
+				automaticShiftingLastTime = 0;
+				shifted = true;
+			}
+		}
+	}
+	if(not shifted and stagedThrottle)
+		engine.throttlePosition = 0;
+}
+
+void Mechanics::updateAutomaticShiftingBySchedule()
+{
+	if(engine.gear < 1 or engine.gear > (int) shiftSchedule.size())
+		return;
+
+	const ShiftScheduleEntry& entry = shiftSchedule[engine.gear-1];
+	if(engine.gear < engine.gearCount and wheelAngularSpeed >= entry.upshiftWheelAngularSpeed)
+	{
+		shiftGear(engine.gear+1);
+		automaticShiftingLastTime = 0;
+	}
+	else if(engine.gear > 1 and wheelAngularSpeed >= entry.downshiftMinWheelAngularSpeed and wheelAngularSpeed < entry.downshiftMaxWheelAngularSpeed)
+	{
+		shiftGear(engine.gear-1);
+		automaticShiftingLastTime = 0;
+	}
+}
+
+// Returns the (throttle-independent) torque factor of the engine at the given RPM, the same way Engine::getTorqueAt() does
+static inline float getTorqueFactorAt(const Engine& engine, float rpm)
+{
+	return rpm > engine.maxRpm ? -rpm/engine.maxRpm : engine.torqueCurveProfile.getTorqueFactor(rpm);
+}
+
+// Returns the (clamped) engine RPM in the given gear when running synchronized with the given wheel angular speed
+static inline float getSynchronizedRpm(const Engine& engine, int gear, float wheelAngularSpeed)
+{
+	const float rpm = wheelAngularSpeed * engine.gearRatio[gear-1] * engine.differentialRatio * Mechanics::RAD_TO_RPM;
+	return rpm < engine.minRpm? engine.minRpm : rpm > engine.maxRpm+100? engine.maxRpm+100 : rpm;
+}
+
+// Same criteria as updateAutomaticShiftingByTorqueComparison(), but assuming the engine is synchronized with the wheels
+bool Mechanics::isUpshiftAdvantageous(int gear, float wheelAngularSpeed)
+{
+	const float nextGearRpm = wheelAngularSpeed * engine.gearRatio[gear] * engine.differentialRatio * RAD_TO_RPM;
+	return nextGearRpm > 0 and getTorqueFactorAt(engine, getSynchronizedRpm(engine, gear, wheelAngularSpeed)) * engine.gearRatio[gear-1]
+								< getTorqueFactorAt(engine, nextGearRpm) * engine.gearRatio[gear];
+}
+
+// Same criteria as updateAutomaticShiftingByTorqueComparison(), but assuming the engine is synchronized with the wheels
+bool Mechanics::isDownshiftAdvantageous(int gear, float wheelAngularSpeed)
+{
+	const float prevGearRpm = wheelAngularSpeed * engine.gearRatio[gear-2] * engine.differentialRatio * RAD_TO_RPM;
+	return prevGearRpm < engine.maxRpm and getTorqueFactorAt(engine, getSynchronizedRpm(engine, gear, wheelAngularSpeed)) * engine.gearRatio[gear-1]
+										< 0.9 * getTorqueFactorAt(engine, prevGearRpm) * engine.gearRatio[gear-2];
+}
+
+void Mechanics::computeShiftSchedule()
+{
+	static const unsigned SAMPLE_COUNT = 1000, REFINEMENT_ITERATIONS = 16;
+
+	// refines the boundary between 'a' (where predicate is 'valueA') and 'b' (where it isn't) by bisection
+	struct Refine { static float boundary(Mechanics& m, bool (Mechanics::*predicate)(int, float), int gear, float a, float b, bool valueA)
+	{
+		for(unsigned i = 0; i < REFINEMENT_ITERATIONS; i++)
+		{
+			const float mid = 0.5f*(a + b);
+			if((m.*predicate)(gear, mid) == valueA) a = mid;
+			else b = mid;
+		}
+		return b;
+	}};
+
+	shiftSchedule.clear();
+	shiftSchedule.resize(engine.gearCount);
+	for(int gear = 1; gear <= engine.gearCount; gear++)
+	{
+		ShiftScheduleEntry& entry = shiftSchedule[gear-1];
+		entry.upshiftWheelAngularSpeed = FLT_MAX;
+		entry.downshiftMinWheelAngularSpeed = entry.downshiftMaxWheelAngularSpeed = 0;
+
+		// upshift: the lowest speed at which the next gear gives more torque (searched up to a bit beyond this gear's redline)
+		if(gear < engine.gearCount)
+		{
+			const float maxSpeed = 1.1f * engine.maxRpm / (engine.gearRatio[gear-1] * engine.differentialRatio * RAD_TO_RPM),
+						step = maxSpeed / SAMPLE_COUNT;
+
+			for(unsigned i = 1; i <= SAMPLE_COUNT; i++)
+				if(isUpshiftAdvantageous(gear, i*step))
+				{
+					entry.upshiftWheelAngularSpeed = Refine::boundary(*this, &Mechanics::isUpshiftAdvantageous, gear, (i-1)*step, i*step, false);
+					break;
+				}
+		}
+
+		// downshift: the speed range in which the previous gear gives enough additional torque (limited by the previous gear's redline)
+		if(gear > 1)
+		{
+			const float maxSpeed = engine.maxRpm / (engine.gearRatio[gear-2] * engine.differentialRatio * RAD_TO_RPM),
+						step = maxSpeed / SAMPLE_COUNT;
+
+			int first = -1, last = -1;
+			for(unsigned i = 0; i < SAMPLE_COUNT; i++)
+				if(isDownshiftAdvantageous(gear, i*step))
+				{
+					if(first == -1) first = i;
+					last = i;
+				}
+
+			if(first != -1)
+			{
+				entry.downshiftMinWheelAngularSpeed = first == 0? 0 : Refine::boundary(*this, &Mechanics::isDownshiftAdvantageous, gear, (first-1)*step, first*step, false);
+				entry.downshiftMaxWheelAngularSpeed = Refine::boundary(*this, &Mechanics::isDownshiftAdvantageous, gear, last*step, (last+1)*step, true);
+			}
+		}
+	}
+}
+
 // ------------------------------------------------------------------------------------------------
 // ---- SIMPLIFIED SCHEME -------------------------------------------------------------------------
 
@@ -214,7 +501,11 @@ void Mechanics::updateBySimplifiedScheme(float delta)
 {
 	// this formula assumes no wheel slipping.
 	wheelAngularSpeed = speed/tireRadius;  // set new wheel angular speed
-	engine.update(delta, wheelAngularSpeed);
+
+	if(integrationMethod == INTEGRATION_METHOD_SEMI_IMPLICIT_EULER)
+		engine.updateSemiImplicit(delta, wheelAngularSpeed);
+	else
+		engine.update(delta, wheelAngularSpeed);
 }
 
 float Mechanics::getDriveForceBySimplifiedSchemeSlipless()
@@ -252,11 +543,30 @@ static const float AVERAGE_WHEEL_DENSITY = 75.0/pow2(3.3);  // d = m/r^2, assumi
 
 void Mechanics::updateByPacejkaScheme(float delta)
 {
-	updateSlipRatio(delta);
+	if(integrationMethod == INTEGRATION_METHOD_SEMI_IMPLICIT_EULER)
+		updateSlipRatioImplicitly(delta);  // updates both slip ratio and wheel angular speed
+	else
+	{
+		updateSlipRatio(delta);
+		wheelAngularSpeed += delta * getWheelAngularAcceleration();  // update wheel angular speed
+	}
+
+	// updated engine RPM based on the wheel angular speed
+	if(integrationMethod == INTEGRATION_METHOD_SEMI_IMPLICIT_EULER)
+		engine.updateSemiImplicit(delta, wheelAngularSpeed);
+	else
+		engine.update(delta, wheelAngularSpeed);
+}
+
+float Mechanics::getDrivenWheelsInertia()
+{
 	const unsigned drivenWheelsCount = wheelCount / (drivenWheelsType == DRIVEN_WHEELS_ALL? 1 : 2);
 	const float wheelMass = AVERAGE_WHEEL_DENSITY * pow2(tireRadius);  // m = d*r^2, assuming wheel width = 1/PI
-	const float drivenWheelsInertia = drivenWheelsCount * wheelMass * pow2(tireRadius) * 0.5;  // I = (mr^2)/2
+	return drivenWheelsCount * wheelMass * pow2(tireRadius) * 0.5;  // I = (mr^2)/2
+}
 
+float Mechanics::getWheelAngularAcceleration()
+{
 	const float tractionForce = getNormalizedTractionForce() * tireFrictionFactor * getDrivenWheelsWeightLoad();
 	const float tractionTorque = tractionForce * tireRadius;
 
@@ -266,11 +576,7 @@ void Mechanics::updateByPacejkaScheme(float delta)
 
 	const float totalTorque = engine.getDriveTorque() - tractionTorque - brakingTorque - rollingResistanceTorque;
 
-	const float arbitraryAdjustmentFactor = 0.002;
-	const float wheelAngularAcceleration = arbitraryAdjustmentFactor * (totalTorque / drivenWheelsInertia);  // XXX we're assuming no inertia from the engine components.
-
-	wheelAngularSpeed += delta * wheelAngularAcceleration;  // update wheel angular speed
-	engine.update(delta, wheelAngularSpeed);  // updated engine RPM based on the wheel angular speed
+	return WHEEL_ANGULAR_ACCELERATION_ARBITRARY_ADJUST * (totalTorque / getDrivenWheelsInertia());  // XXX we're assuming no inertia from the engine components.
 }
 
 float Mechanics::getDriveForceByPacejkaScheme()
@@ -278,19 +584,28 @@ float Mechanics::getDriveForceByPacejkaScheme()
 	return getNormalizedTractionForce() * getDrivenWheelsWeightLoad() * tireFrictionFactor;
 }
 
+// slip ratio computation don't work properly on low speeds due to numerical instability when dividing by values closer and closer to zero
+// in an attempt to attenuate the issue, we follow an approach suggested by Bernard and Clover in [SAE950311]
+static const double B_CONSTANT = 0.91,     // constant
+					TAU_CONSTANT = 0.02,   // oscillation period (experimental)
+					LOWEST_STABLE_SPEED = 5.0f;
+
 void Mechanics::updateSlipRatio(float delta)
 {
-	// slip ratio computation don't work properly on low speeds due to numerical instability when dividing by values closer and closer to zero
-	// in an attempt to attenuate the issue, we follow an approach suggested by Bernard and Clover in [SAE950311]
-	static const double B_CONSTANT = 0.91,     // constant
-						TAU_CONSTANT = 0.02,   // oscillation period (experimental)
-						LOWEST_STABLE_SPEED = 5.0f;
+	const double deltaRatio = getDifferentialSlipRatioRate();
+	differentialSlipRatio += deltaRatio * delta;
+	updateSlipRatioFromDifferential(deltaRatio);
+}
 
+double Mechanics::getDifferentialSlipRatioRate()
+{
 	// approach suggested by Bernard and Clover in [SAE950311].
-	double deltaRatio = ((double) wheelAngularSpeed * (double) tireRadius - (double) speed) - fabs((double) speed) * differentialSlipRatio;
-	deltaRatio /= B_CONSTANT;
-	differentialSlipRatio += deltaRatio * delta;
+	const double deltaRatio = ((double) wheelAngularSpeed * (double) tireRadius - (double) speed) - fabs((double) speed) * differentialSlipRatio;
+	return deltaRatio / B_CONSTANT;
+}
 
+void Mechanics::updateSlipRatioFromDifferential(double deltaRatio)
+{
 	// The differential equation tends to oscillate at low speeds.
 	// To counter this, use a derived value in the force equations.
 	//
@@ -303,11 +618,64 @@ void Mechanics::updateSlipRatio(float delta)
 		slipRatio = differentialSlipRatio;
 }
 
+void Mechanics::updateSlipRatioImplicitly(float delta)
+{
+	// The differential slip ratio equation is stiff at high speeds (its time constant is B/|v|) and, coupled with the wheel
+	// rotation through the traction torque, oscillates at low speeds. Instead of integrating it explicitly, both the slip ratio
+	// and the wheel angular speed are advanced together with a (linearized) backward euler step, which is stable at any time step.
+	if(delta <= 0)
+		return;  // nothing to advance (and the low speed damping below would divide by zero)
+
+	const double h = delta, r = tireRadius, absSpeed = fabs((double) speed), sr = differentialSlipRatio;
+
+	// at low speeds, the traction still uses SR + Tau * d SR/dt (see updateSlipRatioFromDifferential()), which damps the
+	// oscillation; over the step this means using SR' + (Tau/h) * (SR' - SR), so its slope gets scaled by this factor
+	const double tauFactor = speed < LOWEST_STABLE_SPEED? 1 + TAU_CONSTANT/h : 1;
+
+	// wheel angular acceleration at the current slip ratio and its (stabilizing) sensitivity to the slip ratio
+	slipRatio = differentialSlipRatio;
+	const double angularAcceleration = getWheelAngularAcceleration(),
+				 angularAccelerationSlope = tauFactor * WHEEL_ANGULAR_ACCELERATION_ARBITRARY_ADJUST / getDrivenWheelsInertia()
+											* tireFrictionFactor * getDrivenWheelsWeightLoad() * r
+											* std::max(0.0f, getNormalizedTractionForceSlope());
+
+	// w' = w + h*(a + k*(sr - sr'))  and  sr' = sr + h*((w'*r - v) - |v|*sr')/B, solved for sr' and w'
+	const double partialWheelAngularSpeed = wheelAngularSpeed + h*(angularAcceleration + angularAccelerationSlope * sr);
+	differentialSlipRatio = (sr + h*(partialWheelAngularSpeed*r - speed)/B_CONSTANT)
+						  / (1 + h*absSpeed/B_CONSTANT + h*h*r*angularAccelerationSlope/B_CONSTANT);
+	const double newWheelAngularSpeed = partialWheelAngularSpeed - h*angularAccelerationSlope*differentialSlipRatio;
+
+	// the brakes can hold the wheels still, but not spin them backwards (otherwise they chatter around zero when stopped)
+	if(brakePedalPosition > 0 and newWheelAngularSpeed * wheelAngularSpeed < 0)
+	{
+		wheelAngularSpeed = 0;
+		differentialSlipRatio = (sr - h*speed/B_CONSTANT) / (1 + h*absSpeed/B_CONSTANT);
+	}
+	else
+		wheelAngularSpeed = newWheelAngularSpeed;
+
+	slipRatio = tauFactor * differentialSlipRatio - (tauFactor - 1) * sr;
+}
+
 float Mechanics::getNormalizedTractionForce()
 {
+	// the curve is symmetric for negative slip ratios (braking), otherwise traction would grow unbounded as the wheels lock
+	const double absSlipRatio = fabs(slipRatio);
+
 	// approximation/simplification based on a simplified Pacejka's formula from Marco Monster's website "Car Physics for Games".
-	return slipRatio < 0.06? (20.0*slipRatio)  // 0 to 6% slip ratio gives traction from 0 up to 120%
-		 : slipRatio < 0.20? (9.0 - 10.0*slipRatio)/7.0  // 6 to 20% slip ratio gives traction from 120% up to 100%
-		 : slipRatio < 1.00? (1.075 - 0.375*slipRatio)  // 20% to 100% slip ratio gives traction from 100 down to 70%
-				 	 	 	 : 0.7;  // over 100% slip ratio gives traction 70%
+	return sgn(slipRatio) * (
+		   absSlipRatio < 0.06? (20.0*absSlipRatio)  // 0 to 6% slip ratio gives traction from 0 up to 120%
+		 : absSlipRatio < 0.20? (9.0 - 10.0*absSlipRatio)/7.0  // 6 to 20% slip ratio gives traction from 120% up to 100%
+		 : absSlipRatio < 1.00? (1.075 - 0.375*absSlipRatio)  // 20% to 100% slip ratio gives traction from 100 down to 70%
+				 	 	 	 	: 0.7);  // over 100% slip ratio gives traction 70%
+}
+
+float Mechanics::getNormalizedTractionForceSlope()
+{
+	// derivative of getNormalizedTractionForce() with respect to the slip ratio (same for both signs, since the curve is odd)
+	const double absSlipRatio = fabs(slipRatio);
+	return absSlipRatio < 0.06? 20.0
+		 : absSlipRatio < 0.20? -10.0/7.0
+		 : absSlipRatio < 1.00? -0.375
+				 	 	 	 	: 0;
 }
@@ -36,6 +36,25 @@ struct Mechanics
 	}
 	simulationType;
 
+	/** The numerical integration method used to advance the powertrain state (speed, wheel angular speed, engine RPM and slip ratio) over time. */
+	enum IntegrationMethod
+	{
+		INTEGRATION_METHOD_EULER,  // explicit (forward) euler, in the original update order
+		INTEGRATION_METHOD_SEMI_IMPLICIT_EULER,  // semi-implicit euler, with the engine-drivetrain synchronization integrated implicitly
+		INTEGRATION_METHOD_RK2,  // 2nd order runge-kutta (midpoint method)
+		INTEGRATION_METHOD_RK4,  // classic 4th order runge-kutta
+
+		INTEGRATION_METHOD_COUNT  // for counting purposes...
+	}
+	integrationMethod;
+
+	/** Returns the recommended integration method for the given simulation type. */
+	static IntegrationMethod getDefaultIntegrationMethod(SimulationType);
+
+	/** Returns the largest time step (in seconds) that the given simulation type and integration method can take while
+	 *  staying as accurate as the original scheme (explicit euler with 0.01s steps), as benchmarked by the physics regression tool. */
+	static float getMaximumTimeStep(SimulationType, IntegrationMethod);
+
 	enum VehicleType { TYPE_CAR, TYPE_BIKE, TYPE_OTHER } vehicleType;
 
 	Engine engine;
@@ -43,6 +62,22 @@ struct Mechanics
 	bool automaticShiftingEnabled;
 	float automaticShiftingLastTime;
 
+	/** If true (default), automatic shifting decisions are made by comparing the wheel angular speed against the
+	 *  precomputed shift schedule (if one was computed). If false, or if there is no schedule, the torque of the adjacent
+	 *  gears are evaluated on every step instead (reference behavior, useful for validation). */
+	bool automaticShiftingScheduleEnabled;
+
+	/** The wheel angular speeds (in rad/s) at which automatic shifting occurs, for a given gear.
+	 *  An upshift happens at or above 'upshiftWheelAngularSpeed'; a downshift happens within the
+	 *  [downshiftMinWheelAngularSpeed, downshiftMaxWheelAngularSpeed) range. */
+	struct ShiftScheduleEntry
+	{
+		float upshiftWheelAngularSpeed, downshiftMinWheelAngularSpeed, downshiftMaxWheelAngularSpeed;
+	};
+
+	/** The automatic shifting schedule. Each index corresponds to each gear (index 0 is for the 1st gear). */
+	std::vector<ShiftScheduleEntry> shiftSchedule;
+
 	float mass;
 	float tireRadius;
 	unsigned wheelCount;
@@ -88,12 +123,33 @@ struct Mechanics
 
 	void shiftGear(int gear);
 
+	/** Sets the slope angle along with its already known sine, which is then used instead of computing it. */
+	inline void setSlopeAngle(float angle, float angleSine)
+	{
+		slopeAngle = slopeAngleSineArgument = angle;
+		slopeAngleSine = angleSine;
+	}
+
+	/** Computes the automatic shifting schedule for the current engine and transmission settings.
+	 *  Needs to be called again whenever the gear ratios or torque curve are changed. */
+	void computeShiftSchedule();
+
 	/** Returns the current resulting force coming from the powertrain that accelerates the car. */
 	float getDriveForce();
 
 	/** Returns the current total weight load on the driven wheels. */
 	float getDrivenWheelsWeightLoad();
 
+	/** Returns the air drag force at the given speed. */
+	float getAirDragForce(float speed) const;
+
+	/** Returns the downforce at the given speed. */
+	float getDownforce(float speed) const;
+
+	/** Returns the highest drive force this vehicle can produce at the given speed, at full throttle and in the best gear for it. Unless the
+	 *  simulation type is slipless, it is limited by the grip of the driven wheels (without weight transfer). Meant for estimations. */
+	float getMaximumDriveForce(float speed) const;
+
 	/** Returns the maximum angular speed of the driven wheels (in radians) as allowed by this vehicle's geartrain. */
 	inline float getMaximumWheelAngularSpeed()
 	{
@@ -102,6 +158,21 @@ struct Mechanics
 
 	private:
 
+	// Automatic shifting-related
+	void updateAutomaticShiftingBySchedule();
+	void updateAutomaticShiftingByTorqueComparison();
+	bool isUpshiftAdvantageous(int gear, float wheelAngularSpeed);
+	bool isDownshiftAdvantageous(int gear, float wheelAngularSpeed);
+
+	// Integration-related
+	struct State { float speed, wheelAngularSpeed, rpm; double differentialSlipRatio; };
+	float slopeAngleSine, slopeAngleSineArgument;  // the slope angle changes rarely (typically only between course segments), so its sine is cached
+	void updateResistanceForces();
+	float getNetForce();
+	void computeStateDerivative(State& derivative);
+	void setState(const State& initial, const State& derivative, float delta);
+	void updateByRungeKutta(float delta, bool fourthOrder);
+
 	// Simplified scheme-related
 	void updateBySimplifiedScheme(float);
 	float getDriveForceBySimplifiedSchemeSlipless();
@@ -113,10 +184,16 @@ struct Mechanics
 	void updateByPacejkaScheme(float);
 	float getDriveForceByPacejkaScheme();
 	float getNormalizedTractionForce();
+	float getNormalizedTractionForceSlope();
+	float getDrivenWheelsInertia();
+	float getWheelAngularAcceleration();
 
 	// these refer to the longitudinal slip ratio
 	double slipRatio, differentialSlipRatio;
 	void updateSlipRatio(float delta);
+	void updateSlipRatioImplicitly(float delta);
+	double getDifferentialSlipRatioRate();
+	void updateSlipRatioFromDifferential(double differentialSlipRatioRate);
 };
 
 #endif /* AUTOMOTIVE_MECHANICS_HPP_ */
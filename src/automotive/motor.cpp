@@ -5,6 +5,8 @@
  *      Author: carlosfaruolo
  */
 
+#include "strict_floating_point.hpp"  // must come first
+
 #include "motor.hpp"
 
 #include <cmath>
@@ -25,7 +27,9 @@ using std::vector;
 
 static const float ENGINE_FRICTION_COEFFICIENT = 0.2 * 30.0,
 		           TORQUE_POWER_CONVERSION_FACTOR = 5252.0 * 1.355818,
-                   RAD_TO_RPM = (30.0/M_PI);  // 60/2pi conversion to RPM
+                   RAD_TO_RPM = (30.0/M_PI),  // 60/2pi conversion to RPM
+                   ENGINE_SYNCHRONIZATION_FACTOR = 50.0,  // how fast the engine RPM follows the drivetrain RPM when a gear is engaged
+                   TORQUE_CURVE_LOOKUP_MINIMUM_RPM_STEP = 10;  // the finest RPM bucket allowed in the torque curve lookup table (bounds the table size)
 
 /// Stores "baked" parameters in the given float arguments, according to the given PowerBandType parameter.
 /// The first parameter ('l') is the fraction of the engine's maximum torque that is available at 1000RPM
@@ -83,6 +87,8 @@ Engine::TorqueCurveProfile Engine::TorqueCurveProfile::createAsDualLinear(float
 	if(rpmMaxPowerPtr != null)
 		*rpmMaxPowerPtr = xm;
 
+	profile.compile();
+
 	if(maxNormPowerPtr != null)
 		*maxNormPowerPtr = profile.getTorqueFactor(xm)*xm/TORQUE_POWER_CONVERSION_FACTOR;
 
@@ -120,10 +126,70 @@ Engine::TorqueCurveProfile Engine::TorqueCurveProfile::createAsSingleQuadratic(f
 		previousTorqueFactor = torqueFactor;
 	}
 
+	profile.compile();
 	return profile;
 }
 
+Engine::TorqueCurveProfile::TorqueCurveProfile()
+: parameters(), sections(), lookupTable(), lookupRpmStep(0), lookupRpmStepInverse(0)
+{}
+
+void Engine::TorqueCurveProfile::compile()
+{
+	sections.clear();
+	lookupTable.clear();
+	lookupRpmStep = lookupRpmStepInverse = 0;
+
+	if(parameters.empty())
+		return;
+
+	// flatten line sections and find the narrowest one
+	float narrowestWidth = parameters[0][PARAM_RPM], previousRpm = 0;
+	for(unsigned i = 0; i < parameters.size(); i++)
+	{
+		const LineSection section = { parameters[i][PARAM_RPM], parameters[i][PARAM_SLOPE], parameters[i][PARAM_INTERCEPT] };
+		sections.push_back(section);
+		if(section.rpm - previousRpm < narrowestWidth)
+			narrowestWidth = section.rpm - previousRpm;
+		previousRpm = section.rpm;
+	}
+
+	// buckets no wider than the narrowest section, so each one spans at most two sections (except when clamped)
+	lookupRpmStep = narrowestWidth > TORQUE_CURVE_LOOKUP_MINIMUM_RPM_STEP? narrowestWidth : TORQUE_CURVE_LOOKUP_MINIMUM_RPM_STEP;
+	lookupRpmStepInverse = 1.0/lookupRpmStep;
+
+	const unsigned bucketCount = 1 + static_cast<unsigned>(sections.back().rpm * lookupRpmStepInverse);
+	lookupTable.resize(bucketCount);
+	for(unsigned b = 0, i = 0; b < bucketCount; b++)
+	{
+		while(i + 1 < sections.size() and sections[i].rpm <= b*lookupRpmStep)
+			i++;
+
+		// start one section earlier to be safe against rounding of the bucket index
+		lookupTable[b] = i > 0? i-1 : 0;
+	}
+}
+
 float Engine::TorqueCurveProfile::getTorqueFactor(float rpm) const
+{
+	if(rpm < 1)
+		return -1;
+
+	if(lookupTable.empty())
+		return getTorqueFactorByLinearScan(rpm);
+
+	// if over the redline, use the last section
+	if(rpm >= sections.back().rpm)
+		return sections.back().slope*rpm + sections.back().intercept;
+
+	unsigned i = lookupTable[static_cast<unsigned>(rpm * lookupRpmStepInverse)];
+	while(rpm >= sections[i].rpm)
+		i++;
+
+	return sections[i].slope*rpm + sections[i].intercept;
+}
+
+float Engine::TorqueCurveProfile::getTorqueFactorByLinearScan(float rpm) const
 {
 	if(rpm < 1)
 		return -1;
@@ -197,15 +263,13 @@ float Engine::getAngularSpeed()
 	return (gear == 0? rpm : rpm/gearRatio[gear-1]) * differentialRatio * RAD_TO_RPM;
 }
 
-void Engine::update(float delta, float wheelAngularSpeed)
+float Engine::getRpmRate(float wheelAngularSpeed)
 {
 	if(gear != 0)  // engaged gear
 	{
 		//synchronize both rotations  (acts like a synchromesh)
-		const float drivetrainRpm = (wheelAngularSpeed * gearRatio[gear-1] * differentialRatio * RAD_TO_RPM),
-					rpmDiff = drivetrainRpm - rpm, synchonizationFactor = 50.0;
-
-		rpm += delta * synchonizationFactor * rpmDiff;
+		const float drivetrainRpm = (wheelAngularSpeed * gearRatio[gear-1] * differentialRatio * RAD_TO_RPM);
+		return ENGINE_SYNCHRONIZATION_FACTOR * (drivetrainRpm - rpm);
 		// fixme the wheel angular speed should change as well when syncing, but previous attempts got strange behavior
 	}
 	else  // disengaged gear
@@ -214,9 +278,33 @@ void Engine::update(float delta, float wheelAngularSpeed)
 					engineFrictionTorqueRpm = (1-throttlePosition)*(rpm/maxRpm)*maximumTorque*ENGINE_FRICTION_COEFFICIENT,
 					displacementFactor = 1 + (displacement != 0? 10000.0/displacement : 0);
 
-		rpm += delta * (engineFedTorqueRpm - engineFrictionTorqueRpm)*displacementFactor;
+		return (engineFedTorqueRpm - engineFrictionTorqueRpm)*displacementFactor;
 	}
+}
 
+void Engine::update(float delta, float wheelAngularSpeed)
+{
+	rpm += delta * getRpmRate(wheelAngularSpeed);
+	clampRpm();
+}
+
+void Engine::updateSemiImplicit(float delta, float wheelAngularSpeed)
+{
+	if(gear != 0)  // engaged gear: backward euler step of the (linear) synchronization, unconditionally stable
+	{
+		const float drivetrainRpm = (wheelAngularSpeed * gearRatio[gear-1] * differentialRatio * RAD_TO_RPM),
+					relaxation = delta * ENGINE_SYNCHRONIZATION_FACTOR;
+
+		rpm = (rpm + relaxation * drivetrainRpm)/(1 + relaxation);
+	}
+	else
+		rpm += delta * getRpmRate(wheelAngularSpeed);
+
+	clampRpm();
+}
+
+void Engine::clampRpm()
+{
 	if(rpm < minRpm)
 		rpm = minRpm;
 
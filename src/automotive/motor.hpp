@@ -38,6 +38,14 @@ struct Engine
 	{
 		std::vector< std::vector<float> > parameters;  // todo this could be a map...
 
+		/** A line section of the curve, stored contiguously for faster lookups. */
+		struct LineSection { float rpm, slope, intercept; };
+
+		// compiled (flat, direct-indexed) version of 'parameters'. see compile().
+		std::vector<LineSection> sections;
+		std::vector<unsigned> lookupTable;  // for each RPM bucket, the index of the first section which may contain RPMs in that bucket
+		float lookupRpmStep, lookupRpmStepInverse;
+
 		enum PowerBandType {
 			POWER_BAND_TYPICAL,       // peak power at 91.5% of RPM range / peak torque at 55.8% of RPM range
 			POWER_BAND_PEAKY,         // peak power at 94.0% of RPM range / peak torque at 63.4% of RPM range
@@ -48,9 +56,19 @@ struct Engine
 //			POWER_BAND_TYPICAL_ELECTRIC
 		};
 
-		/** Returns the preficted fraction of the maximum torque output in the given RPM. */
+		TorqueCurveProfile();
+
+		/** Returns the preficted fraction of the maximum torque output in the given RPM.
+		 *  Uses the compiled lookup table if available, otherwise scans the 'parameters' list. */
 		float getTorqueFactor(float rpm) const;
 
+		/** Same as getTorqueFactor(), but always scans the 'parameters' list linearly. Slower; meant as a reference for validation. */
+		float getTorqueFactorByLinearScan(float rpm) const;
+
+		/** Builds the lookup table used by getTorqueFactor() from the current 'parameters'.
+		 *  Both static constructors call this already; it only needs to be called again if 'parameters' is changed afterwards. */
+		void compile();
+
 		/** Returns the RPM which theorectically give the maximum torque of this curve. */
 		float getRpmMaxTorque() const;
 
@@ -84,8 +102,18 @@ struct Engine
 	/** Returns the current engine angular speed (which derives from the current RPM). */
 	float getAngularSpeed();
 
+	/** Returns the current rate of change of the engine's RPM (in RPM per second), given the current wheel angular speed. */
+	float getRpmRate(float wheelAngularSpeed);
+
 	/** Updates the engine's state (RPM, gear, etc), given the current wheel angular speed. */
 	void update(float delta, float wheelAngularSpeed);
+
+	/** Same as update(), but the synchronization with the drivetrain (when a gear is engaged) is integrated implicitly,
+	 *  making it stable at any time step. */
+	void updateSemiImplicit(float delta, float wheelAngularSpeed);
+
+	/** Limits the engine's RPM to its operating range. */
+	void clampRpm();
 };
 
 #endif /* MOTOR_HPP_ */
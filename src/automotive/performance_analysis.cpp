@@ -0,0 +1,68 @@
+/*
+ * performance_analysis.cpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#include "performance_analysis.hpp"
+
+static const float
+	QUARTER_MILE_DISTANCE = 402.336,  // in meters
+	SPEED_100KPH = 100/3.6,  // in m/s
+	TOP_SPEED_RESOLUTION = 0.01,  // speed gains smaller than this (in m/s) don't count as "still accelerating"
+	TOP_SPEED_SETTLE_TIME = 5;  // how long (in seconds) without speed gains until the run is considered done
+
+PerformanceAnalysis PerformanceAnalysis::analyze(const Mechanics& body, float timeStep, float maximumDuration)
+{
+	PerformanceAnalysis analysis;
+	analysis.acceleration0to100Time = analysis.quarterMileTime = analysis.quarterMileTrapSpeed = -1;
+	analysis.topSpeed = analysis.topSpeedTime = 0;
+	analysis.gearMaximumSpeed.assign(body.engine.gearCount, -1);
+
+	Mechanics vehicle(body);
+	vehicle.reset();
+	vehicle.integrationMethod = Mechanics::getDefaultIntegrationMethod(vehicle.simulationType);
+	vehicle.automaticShiftingEnabled = true;
+	vehicle.automaticShiftingLastTime = 0;
+	vehicle.shiftGear(1);
+	vehicle.engine.throttlePosition = 1.0;
+
+	double time = 0, distance = 0;  // accumulated over many small steps, so use double precision
+	float lastSignificantSpeed = 0;
+	while(time < maximumDuration)
+	{
+		const float previousSpeed = vehicle.speed;
+		const double previousDistance = distance;
+		vehicle.updatePowertrain(timeStep);
+		distance += vehicle.speed * timeStep;
+		time += timeStep;
+
+		// interpolate within the step the moment each mark was crossed
+		if(analysis.acceleration0to100Time < 0 and vehicle.speed >= SPEED_100KPH)
+			analysis.acceleration0to100Time = time - timeStep * (vehicle.speed - SPEED_100KPH)/(vehicle.speed - previousSpeed);
+
+		if(analysis.quarterMileTime < 0 and distance >= QUARTER_MILE_DISTANCE)
+		{
+			const float fraction = (QUARTER_MILE_DISTANCE - previousDistance)/(distance - previousDistance);
+			analysis.quarterMileTime = time - timeStep * (1 - fraction);
+			analysis.quarterMileTrapSpeed = previousSpeed + fraction * (vehicle.speed - previousSpeed);
+		}
+
+		if(vehicle.engine.gear > 0 and vehicle.speed > analysis.gearMaximumSpeed[vehicle.engine.gear-1])
+			analysis.gearMaximumSpeed[vehicle.engine.gear-1] = vehicle.speed;
+
+		if(vehicle.speed > analysis.topSpeed)
+			analysis.topSpeed = vehicle.speed;
+
+		if(vehicle.speed > lastSignificantSpeed + TOP_SPEED_RESOLUTION)
+		{
+			lastSignificantSpeed = vehicle.speed;
+			analysis.topSpeedTime = time;
+		}
+		else if(time - analysis.topSpeedTime > TOP_SPEED_SETTLE_TIME and analysis.quarterMileTime >= 0)
+			break;
+	}
+
+	return analysis;
+}
@@ -0,0 +1,33 @@
+/*
+ * performance_analysis.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef AUTOMOTIVE_PERFORMANCE_ANALYSIS_HPP_
+#define AUTOMOTIVE_PERFORMANCE_ANALYSIS_HPP_
+#include <ciso646>
+
+#include "mechanics.hpp"
+
+#include <vector>
+
+/** Straight-line performance figures of a vehicle, measured by simulating a standing-start, full throttle run on flat ground,
+ *  with automatic shifting. All speeds are in m/s and all times in seconds. Figures that were not reached are negative. */
+struct PerformanceAnalysis
+{
+	float acceleration0to100Time;  // time to go from 0 to 100 km/h
+	float quarterMileTime, quarterMileTrapSpeed;  // elapsed time and speed at the end of a quarter mile (402.336m)
+	float topSpeed;  // the highest speed reached in the run
+	float topSpeedTime;  // the time when the top speed was (practically) reached
+
+	/** The highest speed reached in each gear (index 0 is for the 1st gear). */
+	std::vector<float> gearMaximumSpeed;
+
+	/** Simulates the run with a copy of the given body and returns its figures. The body's simulation type is used, along with
+	 *  its default integration method. The run ends when the vehicle stops accelerating or when 'maximumDuration' is reached. */
+	static PerformanceAnalysis analyze(const Mechanics& body, float timeStep=0.001, float maximumDuration=180);
+};
+
+#endif /* AUTOMOTIVE_PERFORMANCE_ANALYSIS_HPP_ */
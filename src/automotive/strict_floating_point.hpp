@@ -0,0 +1,31 @@
+/*
+ * strict_floating_point.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef AUTOMOTIVE_STRICT_FLOATING_POINT_HPP_
+#define AUTOMOTIVE_STRICT_FLOATING_POINT_HPP_
+
+/* Include this header (before any other code) in translation units containing physics code, so that its floating-point expressions
+ * are evaluated exactly as written, regardless of compiler or optimization flags. Namely, this forbids contracting multiplications and
+ * additions into fused multiply-adds, which some compilers do by default (when targeting hardware supporting it) and which changes
+ * rounding. This is needed for the physics to be bit-reproducible across builds (see Pseudo3DRaceState's deterministic physics mode).
+ * Note that this does not forbid excess precision (as with x87 FPUs); builds targeting such FPUs should be done with SSE2 math instead
+ * (-mfpmath=sse -msse2 on GCC), otherwise a warning is issued. */
+
+#if defined(__clang__)
+	#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+	#pragma GCC optimize ("fp-contract=off")
+#elif defined(_MSC_VER)
+	#pragma fp_contract (off)
+	#pragma float_control (precise, on)
+#endif
+
+#if defined(__FLT_EVAL_METHOD__) and __FLT_EVAL_METHOD__ != 0
+	#warning "floating-point expressions are evaluated with excess precision; physics will not be bit-reproducible across builds"
+#endif
+
+#endif /* AUTOMOTIVE_STRICT_FLOATING_POINT_HPP_ */
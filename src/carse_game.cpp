@@ -17,6 +17,11 @@
 #include "options_menu_state.hpp"
 #include "course_editor_state.hpp"
 
+#include "audio/audio_loader.hpp"
+#include "audio/sound_cache.hpp"
+
+#include "gfx/image_cache.hpp"
+
 CarseGame::CarseGame()
 : Game("Carse", null, 800, 600), logic(CarseLogic::getInstance()), sharedResources(null)
 {
@@ -27,6 +32,10 @@ CarseGame::~CarseGame()
 {
 	if(sharedResources != null)
 		delete sharedResources;
+
+	AudioLoader::shutdown();
+	SoundCache::shutdown();  // sounds still referenced by states are freed as soon as the states release them
+	ImageCache::shutdown();  // images still referenced by states are freed as soon as the states release them
 }
 
 void CarseGame::initialize()
@@ -52,13 +52,18 @@ CarseLogic::CarseLogic()
 
 void CarseLogic::initialize()
 {
-	this->loadPresetEngineSoundProfiles();
-	this->loadPresetCourseStyles();
+	this->loadPresets();
 	this->loadCourses();
 	this->loadVehicles();
 	this->loadTrafficVehicles();
 }
 
+void CarseLogic::loadPresets()
+{
+	this->loadPresetEngineSoundProfiles();
+	this->loadPresetCourseStyles();
+}
+
 void CarseLogic::onStatesListInitFinished()
 {
 	const Pseudo3DRaceState::RaceType defaultRaceType = Pseudo3DRaceState::RACE_TYPE_LOOP_TIME_TRIAL;
@@ -69,6 +74,9 @@ void CarseLogic::onStatesListInitFinished()
 	nextMatchRaceSettings.hudType = Pseudo3DRaceState::HUD_TYPE_DIALGAUGE_TACHO_NUMERIC_SPEEDO;
 	nextMatchRaceSettings.useCachedDialGauge = false;
 	nextMatchRaceSettings.hudDialGaugePointerImageFilename.clear();
+	nextMatchRaceSettings.deterministicPhysics = false;
+	nextMatchRaceSettings.randomSeed = 0;
+	nextMatchRaceSettings.opponentCount = 0;  // by default, no opponents
 	nextMatchSimulationType = Mechanics::SIMULATION_TYPE_SLIPLESS;
 	nextMatchJumpSimulationEnabled = false;
 
@@ -141,6 +149,15 @@ void CarseLogic::onStatesListInitFinished()
 
 		if(RaceOnlyArgs::imperialUnit.isSet())
 			nextMatchRaceSettings.isImperialUnit = true;
+
+		if(RaceOnlyArgs::opponentCount.isSet())
+			nextMatchRaceSettings.opponentCount = RaceOnlyArgs::opponentCount.getValue();
+
+		if(RaceOnlyArgs::deterministicPhysics.isSet())
+		{
+			nextMatchRaceSettings.deterministicPhysics = true;
+			nextMatchRaceSettings.randomSeed = RaceOnlyArgs::randomSeed.getValue();
+		}
 	}
 	else
 	{
@@ -319,7 +336,7 @@ void CarseLogic::loadPresetEngineSoundProfiles()
 
 			if(prop.containsKey("sound") and not prop.get("sound").empty())
 			{
-				if(prop.get("sound") != "custom")
+				if(prop.get("sound") != "custom" and prop.get("sound") != "synthesized")
 				{
 					pendingPresetFiles.push_back(filename);
 					cout << "read engine sound profile: " << presetName << " (alias)" << endl;
@@ -384,39 +401,47 @@ void CarseLogic::loadCourses()
 	}
 }
 
-void CarseLogic::loadVehicles()
+vector<string> CarseLogic::getPropertiesFilenamesWithinDirectory(const string& folder)
 {
-	cout << "reading vehicles specs..." << endl;
-
-	// create a list of files inside the vehicles folder and inside its subfolders (but not recursively)
-	vector<string> possibleVehiclePropertiesFilenames;
-	const vector<string> vehiclesFolderFilenames = fgeal::filesystem::getFilenamesWithinDirectory(CarseLogic::VEHICLES_FOLDER);
-	for(unsigned i = 0; i < vehiclesFolderFilenames.size(); i++)
+	// create a list of files inside the folder and inside its subfolders (but not recursively)
+	vector<string> possiblePropertiesFilenames;
+	const vector<string> folderFilenames = fgeal::filesystem::getFilenamesWithinDirectory(folder);
+	for(unsigned i = 0; i < folderFilenames.size(); i++)
 	{
-		const string& filename = vehiclesFolderFilenames[i];
+		const string& filename = folderFilenames[i];
 		if(fgeal::filesystem::isFilenameDirectory(filename))
 		{
 			const vector<string> subfolderFilenames = fgeal::filesystem::getFilenamesWithinDirectory(filename);
 			for(unsigned j = 0; j < subfolderFilenames.size(); j++)
-				possibleVehiclePropertiesFilenames.push_back(subfolderFilenames[j]);
+				possiblePropertiesFilenames.push_back(subfolderFilenames[j]);
 		}
-		else possibleVehiclePropertiesFilenames.push_back(filename);
+		else possiblePropertiesFilenames.push_back(filename);
 	}
 
-	// check the list of possible "vehicle properties" filenames
-	for(unsigned i = 0; i < possibleVehiclePropertiesFilenames.size(); i++)
+	// keep only the actual "properties" files
+	vector<string> propertiesFilenames;
+	for(unsigned i = 0; i < possiblePropertiesFilenames.size(); i++)
+		if(fgeal::filesystem::isFilenameArchive(possiblePropertiesFilenames[i]) and ends_with(possiblePropertiesFilenames[i], ".properties"))
+			propertiesFilenames.push_back(possiblePropertiesFilenames[i]);
+
+	return propertiesFilenames;
+}
+
+void CarseLogic::loadVehicles()
+{
+	cout << "reading vehicles specs..." << endl;
+
+	const vector<string> vehiclePropertiesFilenames = getPropertiesFilenamesWithinDirectory(CarseLogic::VEHICLES_FOLDER);
+	for(unsigned i = 0; i < vehiclePropertiesFilenames.size(); i++)
 	{
-		const string& filename = possibleVehiclePropertiesFilenames[i];
-		if(fgeal::filesystem::isFilenameArchive(filename) and ends_with(filename, ".properties"))
+		const string& filename = vehiclePropertiesFilenames[i];
+		Properties prop;
+		prop.load(filename);
+		if(prop.containsKey("definition") and prop.get("definition") == "vehicle")
 		{
-			Properties prop;
-			prop.load(filename);
-			if(prop.containsKey("definition") and prop.get("definition") == "vehicle")
-			{
-				try { vehicles.push_back(Pseudo3DVehicle::Spec::createFromFile(filename)); }
-				catch(const std::exception& e) { cout << "error while reading vehicle specification: " << e.what() << endl; continue; }
-				cout << "read vehicle specification: " << filename << endl;
-			}
+			try { vehicles.push_back(Pseudo3DVehicle::Spec::createFromFile(filename)); }
+			catch(const std::exception& e) { cout << "error while reading vehicle specification: " << e.what() << endl; continue; }
+			cout << "read vehicle specification: " << filename << endl;
 		}
 	}
 }
@@ -425,36 +450,17 @@ void CarseLogic::loadTrafficVehicles()
 {
 	cout << "reading traffic vehicles specs..." << endl;
 
-	// create a list of files inside the traffic folder and inside its subfolders (but not recursively)
-	vector<string> possibleTrafficPropertiesFilenames;
-	const vector<string> trafficFolderFilenames = fgeal::filesystem::getFilenamesWithinDirectory(CarseLogic::TRAFFIC_FOLDER);
-	for(unsigned i = 0; i < trafficFolderFilenames.size(); i++)
+	const vector<string> trafficPropertiesFilenames = getPropertiesFilenamesWithinDirectory(CarseLogic::TRAFFIC_FOLDER);
+	for(unsigned i = 0; i < trafficPropertiesFilenames.size(); i++)
 	{
-		const string& filename = trafficFolderFilenames[i];
-		if(fgeal::filesystem::isFilenameDirectory(filename))
+		const string& filename = trafficPropertiesFilenames[i];
+		Properties prop;
+		prop.load(filename);
+		if(prop.containsKey("definition") and prop.get("definition") == "vehicle")
 		{
-			const vector<string> subfolderFilenames = fgeal::filesystem::getFilenamesWithinDirectory(filename);
-			for(unsigned j = 0; j < subfolderFilenames.size(); j++)
-				possibleTrafficPropertiesFilenames.push_back(subfolderFilenames[j]);
-		}
-		else possibleTrafficPropertiesFilenames.push_back(filename);
-	}
-
-	// check the list of possible "traffic vehicles properties" filenames
-	for(unsigned i = 0; i < possibleTrafficPropertiesFilenames.size(); i++)
-	{
-		const string& filename = possibleTrafficPropertiesFilenames[i];
-		if(fgeal::filesystem::isFilenameArchive(filename) and ends_with(filename, ".properties"))
-		{
-			Properties prop;
-			prop.load(filename);
-			if(prop.containsKey("definition") and prop.get("definition") == "vehicle")
-			{
-				try { trafficVehicles.push_back(Pseudo3DVehicle::Spec::createFromFile(filename)); }
-				catch(const std::exception& e) { cout << "error while reading traffic specification: " << e.what() << endl; continue; }
-				cout << "read traffic specification: " << filename << endl;
-				trafficVehicles.back().soundProfile = EngineSoundProfile();  // force no sound for traffic FIXME remove this line and deal with engine sound sharing properly between traffic vehicles
-			}
+			try { trafficVehicles.push_back(Pseudo3DVehicle::Spec::createFromFile(filename)); }
+			catch(const std::exception& e) { cout << "error while reading traffic specification: " << e.what() << endl; continue; }
+			cout << "read traffic specification: " << filename << endl;
 		}
 	}
 }
@@ -659,6 +665,27 @@ EngineSoundProfile CarseLogic::createEngineSoundProfileFromFile(const string& fi
 			struct RangeProfileCompare { static bool function(const EngineSoundProfile::RangeProfile& p1, const EngineSoundProfile::RangeProfile& p2) { return p1.startRpm < p2.startRpm; } };
 			std::stable_sort(profile.ranges.begin(), profile.ranges.end(), RangeProfileCompare::function);
 		}
+		else if(prop.get(baseKey) == "synthesized")
+		{
+			profile.synthesized = true;
+			EngineSoundSynthesis::Parameters& parameters = profile.synthesisParameters;
+
+			string key = baseKey + "_cylinder_count";
+			if(isValueSpecified(prop, key))
+				parameters.cylinderCount = std::max(1, atoi(prop.get(key).c_str()));
+
+			key = baseKey + "_firing_irregularity";
+			if(isValueSpecified(prop, key))
+				parameters.firingIrregularity = std::max(0.0, std::min(1.0, atof(prop.get(key).c_str())));
+
+			key = baseKey + "_exhaust_resonance";
+			if(isValueSpecified(prop, key) and atof(prop.get(key).c_str()) > 0)
+				parameters.exhaustResonance = atof(prop.get(key).c_str());
+
+			key = baseKey + "_roughness";
+			if(isValueSpecified(prop, key))
+				parameters.roughness = std::max(0.0, std::min(1.0, atof(prop.get(key).c_str())));
+		}
 		else
 			throw std::logic_error("properties specify a preset profile instead of a custom one");
 	}
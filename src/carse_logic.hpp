@@ -83,6 +83,13 @@ class CarseLogic
 		return *instance;
 	}
 
+	/* Loads the preset engine sound profiles and course styles, which are needed to load vehicle and course specs. Already done on
+	 * startup; intended for headless tools, which load specs without initializing the game. */
+	void loadPresets();
+
+	/* Returns the filenames of all ".properties" files inside the given folder and inside its subfolders (but not recursively). */
+	static std::vector<std::string> getPropertiesFilenamesWithinDirectory(const std::string& folder);
+
 	/* Creates a engine sound profile by loading and parsing the data in the given filename. */
 	static EngineSoundProfile createEngineSoundProfileFromFile(const std::string& filename);
 
@@ -7,6 +7,8 @@
 
 #include "course.hpp"
 
+#include "gfx/image_cache.hpp"
+
 #include "futil/random.h"
 
 #include "psimpl/psimpl.h"
@@ -25,8 +27,11 @@ using fgeal::Point;
 using fgeal::Rectangle;
 using futil::random_between_decimal;
 
+// how many prescaled levels each prop image gets, at most, and the smallest size (in pixels) of a level
+static const unsigned PROP_MIP_LEVEL_COUNT = 3, MINIMUM_MIP_LEVEL_SIZE = 4;
+
 Pseudo3DCourse::Pseudo3DCourse()
-: spec(100, 1000), sprites(),
+: spec(100, 1000), sprites(), spriteMipLevels(),
   drawAreaWidth(), drawAreaHeight(), drawDistance(1),
   cameraDepth(100), cameraHeight(1500),
   lengthScale(1)
@@ -37,25 +42,33 @@ inline static float fractional_part(float value)
 	return value - (int) value;
 }
 
+static void releaseImages(const vector<Image*>& images, const vector< vector<Image*> >& mipLevels)
+{
+	for(unsigned i = 0; i < images.size(); i++)
+		ImageCache::release(images[i]);
+
+	for(unsigned i = 0; i < mipLevels.size(); i++)
+		for(unsigned level = 0; level < mipLevels[i].size(); level++)
+			ImageCache::release(mipLevels[i][level]);
+}
+
 Pseudo3DCourse::~Pseudo3DCourse()
 {
-	if(not sprites.empty())
-	{
-		for(unsigned i = 0; i < sprites.size(); i++)
-			delete sprites[i];
-	}
+	releaseImages(sprites, spriteMipLevels);
 }
 
 void Pseudo3DCourse::loadSpec(const Spec& s)
 {
-	// free assets' data
-	if(not sprites.empty())
-	{
-		for(unsigned i = 0; i < sprites.size(); i++)
-			delete sprites[i];
+	setSpec(s);
+	loadAssetsData();
+}
 
-		sprites.clear();
-	}
+void Pseudo3DCourse::setSpec(const Spec& s)
+{
+	// free assets' data
+	releaseImages(sprites, spriteMipLevels);
+	sprites.clear();
+	spriteMipLevels.clear();
 
 	// set new spec and reset some values
 	spec = s;
@@ -63,13 +76,35 @@ void Pseudo3DCourse::loadSpec(const Spec& s)
 	// resize cache when needed
 	if(coordCache.size() != spec.lines.size())
 		coordCache.resize(spec.lines.size(), ScreenCoordCache());
+}
+
+void Pseudo3DCourse::loadAssetsData()
+{
+	// previously loaded images are released only afterwards, so that they're not reloaded if they're the same
+	const vector<Image*> previousSprites = sprites;
+	const vector< vector<Image*> > previousSpriteMipLevels = spriteMipLevels;
+	sprites.clear();
+	spriteMipLevels.clear();
 
-	// load assets' data
 	for(unsigned i = 0; i < spec.spritesFilenames.size(); i++)
+	{
+		spriteMipLevels.push_back(vector<Image*>());
 		if(not spec.spritesFilenames[i].empty())
-			sprites.push_back(new Image(spec.spritesFilenames[i]));
+		{
+			Image* const image = ImageCache::acquire(spec.spritesFilenames[i]);  // props are usually the same from race to race
+			sprites.push_back(image);
+
+			// distant props are drawn from smaller images, instead of minifying the full image on every frame
+			for(unsigned level = 1; level <= PROP_MIP_LEVEL_COUNT
+					and ImageCache::getMipLevelCellSize(image->getWidth(), level) >= MINIMUM_MIP_LEVEL_SIZE
+					and ImageCache::getMipLevelCellSize(image->getHeight(), level) >= MINIMUM_MIP_LEVEL_SIZE; level++)
+				spriteMipLevels.back().push_back(ImageCache::acquireMipLevel(spec.spritesFilenames[i], level));
+		}
 		else
 			sprites.push_back(null);
+	}
+
+	releaseImages(previousSprites, previousSpriteMipLevels);
 }
 
 //custom call to draw quad
@@ -171,7 +206,18 @@ void Pseudo3DCourse::draw(int pos, int posX)
 			const float sw = w, sh = h-h*clipH/destH;
 
 			if(not (clipH >= destH or destW > this->drawAreaWidth or destH > this->drawAreaHeight or sh <= 1))
-				propImage.drawScaledRegion(destX, destY, scale, scale, Image::FLIP_NONE, 0, 0, sw, sh);
+			{
+				// use the smallest prescaled level that is still minified (so it's not magnified)
+				const vector<Image*>& mipLevels = spriteMipLevels[segment.propIndex];
+				unsigned level = 0;
+				while(level < mipLevels.size() and scale * (2 << level) <= 1)
+					level++;
+
+				Image& levelImage = (level == 0? propImage : *mipLevels[level-1]);
+				const float levelFactorX = w / static_cast<float>(levelImage.getWidth()),
+							levelFactorY = h / static_cast<float>(levelImage.getHeight());
+				levelImage.drawScaledRegion(destX, destY, scale * levelFactorX, scale * levelFactorY, Image::FLIP_NONE, 0, 0, sw / levelFactorX, sh / levelFactorY);
+			}
 		}
 
 		for(unsigned i = 0; i < vehicles.size() and vehicles[i] != null; i++)
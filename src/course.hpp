@@ -135,6 +135,9 @@ struct Pseudo3DCourse
 	Spec spec;
 	std::vector<fgeal::Image*> sprites;
 
+	// prescaled (successively half-sized) versions of each prop's image, used when drawn small; level n is at index n-1 (see ImageCache::acquireMipLevel())
+	std::vector< std::vector<fgeal::Image*> > spriteMipLevels;
+
 	// drawing parameters
 	int drawAreaWidth, drawAreaHeight;
 	unsigned drawDistance;
@@ -150,8 +153,15 @@ struct Pseudo3DCourse
 	Pseudo3DCourse();
 	~Pseudo3DCourse();
 
+	/** Sets the given spec and loads its assets (same as calling setSpec() and then loadAssetsData()). */
 	void loadSpec(const Spec&);
 
+	/** Sets the given spec, releasing any previously loaded assets, but without loading the new spec's assets. */
+	void setSpec(const Spec&);
+
+	/** Loads the assets (props' images) of the current spec (through the ImageCache, so images already loaded are not loaded again). */
+	void loadAssetsData();
+
 	void draw(int positionZ, int positionX);
 };
 
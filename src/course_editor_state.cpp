@@ -11,6 +11,8 @@
 
 #include "util.hpp"
 
+#include "gfx/image_cache.hpp"
+
 #include "futil/string_actions.hpp"
 #include "futil/random.h"
 #include "futil/collection_actions.hpp"
@@ -50,11 +52,12 @@ CourseEditorState::CourseEditorState(CarseGame* game)
 CourseEditorState::~CourseEditorState()
 {
 	if(font != null) delete font;
+	ImageCache::release(imgMenuCourseArrow);
 }
 
 void CourseEditorState::initialize()
 {
-	imgMenuCourseArrow = new Image("assets/arrow-blue.png");
+	imgMenuCourseArrow = ImageCache::acquire("assets/arrow-blue.png");
 	font = new Font(game.sharedResources->font1Path);
 
 	fileMenu.setFont(font);
@@ -9,6 +9,10 @@
 
 #include "pseudo3d_race_state.hpp"
 #include "util.hpp"
+
+#include "audio/audio_loader.hpp"
+#include "gfx/image_cache.hpp"
+
 #include "futil/string_actions.hpp"
 
 #include <cmath>
@@ -38,6 +42,7 @@ enum SettingsMenuIndex
 	SETTINGS_RACE_TYPE = 0,
 	SETTINGS_LAPS = 1,
 	SETTINGS_TRAFFIC_DENSITY = 2,
+	SETTINGS_OPPONENTS = 3,
 	SETTINGS_MENU_COUNT
 };
 
@@ -60,11 +65,11 @@ CourseSelectionState::CourseSelectionState(CarseGame* game)
 
 CourseSelectionState::~CourseSelectionState()
 {
-	if(backgroundImage != null) delete backgroundImage;
-	if(imgRandom != null) delete imgRandom;
-	if(imgCircuit != null) delete imgCircuit;
-	if(imgCourseEditor != null) delete imgCourseEditor;
-	if(imgMenuCourseArrow != null) delete imgMenuCourseArrow;
+	ImageCache::release(backgroundImage);
+	ImageCache::release(imgRandom);
+	ImageCache::release(imgCircuit);
+	ImageCache::release(imgCourseEditor);
+	ImageCache::release(imgMenuCourseArrow);
 	if(fontMain != null) delete fontMain;
 	if(fontInfo != null) delete fontInfo;
 	if(fontSmall != null) delete fontSmall;
@@ -72,11 +77,11 @@ CourseSelectionState::~CourseSelectionState()
 
 void CourseSelectionState::initialize()
 {
-	backgroundImage = new Image("assets/course-menu-bg.jpg");
-	imgRandom = new Image("assets/portrait-random.png");
-	imgCircuit = new Image("assets/portrait-circuit.png");
-	imgCourseEditor = new Image("assets/portrait-course-editor.png");
-	imgMenuCourseArrow = new Image("assets/arrow-blue.png");
+	backgroundImage = ImageCache::acquire("assets/course-menu-bg.jpg");
+	imgRandom = ImageCache::acquire("assets/portrait-random.png");
+	imgCircuit = ImageCache::acquire("assets/portrait-circuit.png");
+	imgCourseEditor = ImageCache::acquire("assets/portrait-course-editor.png");
+	imgMenuCourseArrow = ImageCache::acquire("assets/arrow-blue.png");
 
 	fontMain = new Font(game.sharedResources->font2Path);
 	fontInfo = new Font(game.sharedResources->font1Path);
@@ -221,6 +226,10 @@ void CourseSelectionState::onLeave()
 		game.logic.setNextCourseDebug();
 	else
 		game.logic.setNextCourseRandom();
+
+	// the race usually comes next; have its music ready by then (no-op if already prefetched while browsing)
+	if(not game.logic.getNextCourse().musicFilename.empty())
+		AudioLoader::prefetchMusic(game.logic.getNextCourse().musicFilename);
 }
 
 void CourseSelectionState::render()
@@ -298,6 +307,9 @@ void CourseSelectionState::render()
 
 void CourseSelectionState::update(float delta)
 {
+	// load the music of the course highlighted on a previous frame, if not yet loaded (see below)
+	AudioLoader::process();
+
 	if(menuCourse.getSelectedIndex() > 1)
 	{
 		if(courseMapViewer.spec.filename != game.logic.getCourseList()[menuCourse.getSelectedIndex() - 2].filename)
@@ -306,6 +318,9 @@ void CourseSelectionState::update(float delta)
 			courseMapViewer.scale.scale(0);
 			courseMapViewer.offset.scale(0);
 			courseMapViewer.compile();
+
+			if(not courseMapViewer.spec.musicFilename.empty())
+				AudioLoader::prefetchMusic(courseMapViewer.spec.musicFilename);
 		}
 	}
 	else if(not courseMapViewer.spec.filename.empty())
@@ -327,6 +342,7 @@ void CourseSelectionState::updateMenuSettingsLabels()
 		menuSettings.getEntryAt(SETTINGS_LAPS).label = "Laps: --";
 
 	menuSettings.getEntryAt(SETTINGS_TRAFFIC_DENSITY).label = "Traffic (experimental): " + to_string(raceSettings.trafficDensity*100) + "%";
+	menuSettings.getEntryAt(SETTINGS_OPPONENTS).label = "Opponents (experimental): " + to_string(raceSettings.opponentCount);
 }
 
 void CourseSelectionState::onKeyPressed(Keyboard::Key key)
@@ -463,6 +479,18 @@ void CourseSelectionState::handleInputOnSettings(Keyboard::Key key)
 
 					break;
 				}
+				case SETTINGS_OPPONENTS:
+				{
+					if(isCursorLeft)
+					{
+						if(raceSettings.opponentCount > 0)
+							raceSettings.opponentCount--;
+					}
+					else
+						raceSettings.opponentCount++;
+
+					break;
+				}
 				default: break;
 			}
 
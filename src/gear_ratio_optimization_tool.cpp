@@ -0,0 +1,323 @@
+/*
+ * gear_ratio_optimization_tool.cpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#include "gear_ratio_optimization_tool.hpp"
+
+#include "carse_logic.hpp"
+#include "course.hpp"
+#include "vehicle.hpp"
+#include "pseudo3d_race_state.hpp"
+#include "tool_util.hpp"
+
+#include "automotive/performance_analysis.hpp"
+#include "racing/lap_time_estimate.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+
+#include <cstdlib>
+#include <cmath>
+#include <cfloat>
+#include <ctime>
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+static const float MAXIMUM_LAP_DURATION = 900,  // in seconds; candidates that don't complete a lap by then are discarded
+				   MAXIMUM_ACCELERATION_RUN_DURATION = 60,  // in seconds; same for acceleration runs
+				   ACCELERATION_RUN_TIME_STEP = 0.001;
+
+static const unsigned SEARCH_ROUND_COUNT = 4,
+					  DIFFERENTIAL_RATIO_STEP_COUNT = 7,
+					  GEAR_SPREAD_STEP_COUNT = 7,
+					  GEAR_PROGRESSION_STEP_COUNT = 5;
+
+// the initial search ranges; each round halves them around the best candidate so far
+static const float DIFFERENTIAL_RATIO_FACTOR_MIN = 0.5, DIFFERENTIAL_RATIO_FACTOR_MAX = 2.0,  // relative to the vehicle's current differential ratio
+				   GEAR_SPREAD_MIN = 1.5, GEAR_SPREAD_MAX = 6.0,  // first gear ratio over top gear ratio
+				   GEAR_PROGRESSION_MIN = 0.6, GEAR_PROGRESSION_MAX = 1.4;  // 1 means geometric spacing; higher values bring the upper gears closer together
+
+namespace  // anonymous
+{
+	enum Objective { OBJECTIVE_LAP_TIME, OBJECTIVE_ACCELERATION_0_TO_100, OBJECTIVE_QUARTER_MILE };
+
+	// a set of gear ratios, parametrized by the differential ratio and by the spread and progression of the gearbox ratios
+	struct GearingCandidate
+	{
+		float differentialRatio, gearSpread, gearProgression;
+		float score;  // the objective's value (in seconds), or FLT_MAX if the objective was not reached
+
+		GearingCandidate(float differentialRatio, float gearSpread, float gearProgression)
+		: differentialRatio(differentialRatio), gearSpread(gearSpread), gearProgression(gearProgression), score(FLT_MAX) {}
+	};
+
+	// data shared between worker threads; each worker repeatedly picks the next unevaluated candidate
+	struct OptimizationContext
+	{
+		const Mechanics& body;
+		Objective objective;
+		const Pseudo3DCourse::Spec* course;
+		vector<float> slopeAngle;  // of each of the course's segments
+		float maximumStrafeSpeed;
+
+		vector<GearingCandidate>* candidates;
+
+		OptimizationContext(const Mechanics& body, Objective objective, const Pseudo3DCourse::Spec* course)
+		: body(body), objective(objective), course(course), slopeAngle(), maximumStrafeSpeed(Pseudo3DRaceState::getMaximumStrafeSpeed(body)),
+		  candidates(null)
+		{
+			if(course != null)
+				for(unsigned i = 0; i < course->lines.size(); i++)
+					slopeAngle.push_back(course->getSlopeAngle(i));
+		}
+	};
+}
+
+// sets the given candidate's ratios on the given body, keeping its top gear ratio
+static void applyGearing(Mechanics& body, const GearingCandidate& candidate)
+{
+	const int gearCount = body.engine.gearCount;
+	const float topGearRatio = body.engine.gearRatio[gearCount-1];
+	for(int g = 0; g < gearCount - 1; g++)
+	{
+		const float position = static_cast<float>(gearCount - 1 - g) / (gearCount - 1);  // 1 for the first gear, approaching 0 for the top gear
+		body.engine.gearRatio[g] = topGearRatio * pow(candidate.gearSpread, pow(position, candidate.gearProgression));
+	}
+	body.engine.differentialRatio = candidate.differentialRatio;
+	body.computeShiftSchedule();
+}
+
+// drives a standing-start lap at the vehicle's limits (as estimated by LapTimeEstimate), returning its time, or FLT_MAX if not completed
+static float simulateLap(const Mechanics& body, const OptimizationContext& context)
+{
+	const Pseudo3DCourse::Spec& course = *context.course;
+	const unsigned segmentCount = course.lines.size();
+	const float timeStep = Pseudo3DRaceState::DETERMINISTIC_PHYSICS_TIME_STEP,
+				courseLength = segmentCount * course.roadSegmentLength / Pseudo3DRaceState::DEFAULT_COURSE_POSITION_FACTOR;
+
+	const LapTimeEstimate limits = LapTimeEstimate::estimate(course, Pseudo3DRaceState::DEFAULT_COURSE_POSITION_FACTOR, body, context.maximumStrafeSpeed);
+	if(limits.lapTime < 0)
+		return FLT_MAX;
+
+	Mechanics vehicle(body);
+	vehicle.reset();
+	vehicle.integrationMethod = Mechanics::getDefaultIntegrationMethod(vehicle.simulationType);
+	vehicle.automaticShiftingEnabled = true;
+	vehicle.automaticShiftingLastTime = 0;
+	vehicle.shiftGear(1);
+
+	float position = 0;
+	const unsigned stepCount = MAXIMUM_LAP_DURATION / timeStep;
+	for(unsigned step = 1; step <= stepCount; step++)
+	{
+		// driven like an opponent, following the estimated speed limits
+		const unsigned segmentIndex = static_cast<unsigned>(position * Pseudo3DRaceState::DEFAULT_COURSE_POSITION_FACTOR / course.roadSegmentLength) % segmentCount;
+		Pseudo3DRaceState::updateOpponentSpeedControl(vehicle, segmentIndex, limits.speed, course, Pseudo3DRaceState::DEFAULT_COURSE_POSITION_FACTOR);
+		vehicle.setSlopeAngle(context.slopeAngle[segmentIndex], course.getSlopeAngleSine(segmentIndex));
+		vehicle.updatePowertrain(timeStep);
+
+		position += vehicle.speed * timeStep;
+		if(position >= courseLength)
+			return step * timeStep;
+	}
+	return FLT_MAX;
+}
+
+// returns the objective's value (in seconds) for the given body, or FLT_MAX if not reached
+static float evaluate(const Mechanics& body, const OptimizationContext& context)
+{
+	if(context.objective == OBJECTIVE_LAP_TIME)
+		return simulateLap(body, context);
+
+	const PerformanceAnalysis result = PerformanceAnalysis::analyze(body, ACCELERATION_RUN_TIME_STEP, MAXIMUM_ACCELERATION_RUN_DURATION);
+	const float time = context.objective == OBJECTIVE_ACCELERATION_0_TO_100? result.acceleration0to100Time : result.quarterMileTime;
+	return time < 0? FLT_MAX : time;
+}
+
+// scores the given candidate of the context (called from worker threads, see runParallelJobs())
+static void evaluateCandidate(void* arg, unsigned candidateIndex)
+{
+	const OptimizationContext& context = *static_cast<OptimizationContext*>(arg);
+	GearingCandidate& candidate = context.candidates->at(candidateIndex);
+	Mechanics body(context.body);
+	applyGearing(body, candidate);
+	candidate.score = evaluate(body, context);
+}
+
+// evaluates all given candidates with the given number of threads
+static void evaluateAll(vector<GearingCandidate>& candidates, OptimizationContext& context, unsigned threadCount)
+{
+	context.candidates = &candidates;
+	runParallelJobs(evaluateCandidate, &context, candidates.size(), threadCount);
+}
+
+// returns 'count' values evenly spaced within [min, max] (or just their middle if 'count' is 1)
+static vector<float> getEvenlySpacedValues(float min, float max, unsigned count)
+{
+	vector<float> values;
+	for(unsigned i = 0; i < count; i++)
+		values.push_back(count > 1? min + (max - min) * i / (count - 1) : 0.5f * (min + max));
+	return values;
+}
+
+static string formatTime(float time)
+{
+	if(time == FLT_MAX)
+		return "not reached";
+
+	std::ostringstream stream;
+	stream.setf(std::ios::fixed);
+	stream.precision(3);
+	stream << time << "s";
+	return stream.str();
+}
+
+static string formatPropertiesFragment(const Mechanics& body, const string& description)
+{
+	std::ostringstream stream;
+	stream.precision(4);
+	stream << "# " << description << "\n";
+	stream << "gear_count = " << body.engine.gearCount << "\n";
+	stream << "gear_ratios = custom\n";
+	for(int g = 0; g < body.engine.gearCount; g++)
+		stream << "gear_" << (g+1) << "_ratio = " << body.engine.gearRatio[g] << "\n";
+	stream << "gear_reverse_ratio = " << body.engine.reverseGearRatio << "\n";
+	stream << "gear_differential_ratio = " << body.engine.differentialRatio << "\n";
+	return stream.str();
+}
+
+int runGearRatioOptimizationTool(const string& vehicleFilename, const string& objectiveName, const string& courseFilename,
+	unsigned simulationType, unsigned threadCount, const string& outputFilename)
+{
+	Objective objective;
+	if(objectiveName == "lap") objective = OBJECTIVE_LAP_TIME;
+	else if(objectiveName == "0-100") objective = OBJECTIVE_ACCELERATION_0_TO_100;
+	else if(objectiveName == "quarter-mile") objective = OBJECTIVE_QUARTER_MILE;
+	else
+	{
+		cout << "error: unknown optimization objective \"" << objectiveName << "\" (expected \"lap\", \"0-100\" or \"quarter-mile\")" << endl;
+		return EXIT_FAILURE;
+	}
+
+	if(simulationType >= Mechanics::SIMULATION_TYPE_COUNT)
+	{
+		cout << "error: invalid simulation type index " << simulationType << endl;
+		return EXIT_FAILURE;
+	}
+
+	CarseLogic::getInstance().loadPresets();  // vehicle specs may refer to preset engine sound profiles
+
+	Pseudo3DVehicle::Spec spec;
+	spec.loadFromFile(vehicleFilename);
+
+	Pseudo3DVehicle vehicle;
+	vehicle.setSpec(spec);
+	vehicle.body.simulationType = static_cast<Mechanics::SimulationType>(simulationType);
+	vehicle.body.tireFrictionFactor = Pseudo3DRaceState::TIRE_FRICTION_COEFFICIENT_DRY_ASPHALT;
+	vehicle.body.rollingResistanceFactor = Pseudo3DRaceState::ROLLING_RESISTANCE_COEFFICIENT_DRY_ASPHALT;
+
+	Pseudo3DCourse::Spec course(0, 0);
+	if(objective == OBJECTIVE_LAP_TIME)
+	{
+		if(courseFilename.empty())
+		{
+			cout << "error: a course must be specified to optimize for lap time" << endl;
+			return EXIT_FAILURE;
+		}
+		course.loadFromFile(courseFilename);
+		if(course.lines.empty())
+		{
+			cout << "error: course " << courseFilename << " has no segments" << endl;
+			return EXIT_FAILURE;
+		}
+	}
+	const string objectiveDescription = objective == OBJECTIVE_LAP_TIME? "lap time on " + courseFilename : objectiveName + " time";
+
+	if(threadCount == 0)
+		threadCount = getProcessorCount();
+
+	OptimizationContext context(vehicle.body, objective, objective == OBJECTIVE_LAP_TIME? &course : null);
+
+	const float currentScore = evaluate(vehicle.body, context);  // with the vehicle's current ratios, as a reference
+	cout << "optimizing gear ratios of " << spec.name << " for " << objectiveDescription << " (" << SIMULATION_TYPE_NAMES[simulationType]
+		 << " simulation) with " << threadCount << " thread(s); current ratios: " << formatTime(currentScore) << endl;
+
+	// the search starts centered on the middle of the initial ranges
+	GearingCandidate best(vehicle.body.engine.differentialRatio * sqrt(DIFFERENTIAL_RATIO_FACTOR_MIN * DIFFERENTIAL_RATIO_FACTOR_MAX),
+						  sqrt(GEAR_SPREAD_MIN * GEAR_SPREAD_MAX), 0.5f * (GEAR_PROGRESSION_MIN + GEAR_PROGRESSION_MAX));
+	float differentialRatioLogSpan = 0.5f * log(DIFFERENTIAL_RATIO_FACTOR_MAX / DIFFERENTIAL_RATIO_FACTOR_MIN),
+		  gearSpreadLogSpan = 0.5f * log(GEAR_SPREAD_MAX / GEAR_SPREAD_MIN),
+		  gearProgressionSpan = 0.5f * (GEAR_PROGRESSION_MAX - GEAR_PROGRESSION_MIN);
+
+	vector<GearingCandidate> candidates;
+	const clock_t startTime = clock();
+	const time_t startWallTime = time(null);
+	unsigned evaluationCount = 0;
+	for(unsigned round = 0; round < SEARCH_ROUND_COUNT; round++)
+	{
+		// a grid around the best candidate so far (ratios are spaced logarithmically)
+		const vector<float> differentialRatioLogs = getEvenlySpacedValues(log(best.differentialRatio) - differentialRatioLogSpan, log(best.differentialRatio) + differentialRatioLogSpan, DIFFERENTIAL_RATIO_STEP_COUNT),
+							gearSpreadLogs = getEvenlySpacedValues(log(best.gearSpread) - gearSpreadLogSpan, log(best.gearSpread) + gearSpreadLogSpan, GEAR_SPREAD_STEP_COUNT),
+							gearProgressions = getEvenlySpacedValues(best.gearProgression - gearProgressionSpan, best.gearProgression + gearProgressionSpan, GEAR_PROGRESSION_STEP_COUNT);
+
+		candidates.clear();
+		for(unsigned d = 0; d < differentialRatioLogs.size(); d++)
+			for(unsigned s = 0; s < gearSpreadLogs.size(); s++)
+				for(unsigned p = 0; p < gearProgressions.size(); p++)
+					if(gearSpreadLogs[s] > 0 and gearProgressions[p] > 0)  // keep the gears in order
+						candidates.push_back(GearingCandidate(exp(differentialRatioLogs[d]), exp(gearSpreadLogs[s]), gearProgressions[p]));
+
+		if(round > 0)
+			candidates.push_back(best);  // so that the best candidate is kept even if the new grid misses it
+
+		evaluateAll(candidates, context, std::min<unsigned>(threadCount, candidates.size()));
+		evaluationCount += candidates.size();
+
+		for(unsigned i = 0; i < candidates.size(); i++)
+			if(candidates[i].score < best.score)
+				best = candidates[i];
+
+		cout << "round " << (round+1) << "/" << SEARCH_ROUND_COUNT << ": " << candidates.size() << " candidates, best so far: " << formatTime(best.score) << endl;
+
+		differentialRatioLogSpan *= 0.5f;
+		gearSpreadLogSpan *= 0.5f;
+		gearProgressionSpan *= 0.5f;
+	}
+
+	cout << "evaluated " << evaluationCount << " candidates in " << difftime(time(null), startWallTime) << "s ("
+		 << static_cast<double>(clock() - startTime) / CLOCKS_PER_SEC << "s of CPU time)" << endl;
+
+	if(best.score == FLT_MAX)
+	{
+		cout << "error: no candidate reached the objective" << endl;
+		return EXIT_FAILURE;
+	}
+
+	Mechanics optimizedBody(vehicle.body);
+	applyGearing(optimizedBody, best);
+	const string fragment = formatPropertiesFragment(optimizedBody, "gear ratios optimized for " + objectiveDescription + " (" + SIMULATION_TYPE_NAMES[simulationType]
+			+ " simulation): " + formatTime(best.score) + ", was " + formatTime(currentScore));
+
+	cout << fragment;
+
+	std::ofstream out(outputFilename.c_str());
+	if(not out)
+	{
+		cout << "error: could not open " << outputFilename << " for writing" << endl;
+		return EXIT_FAILURE;
+	}
+	out << fragment;
+
+	cout << "wrote gear ratios to " << outputFilename << endl;
+	return EXIT_SUCCESS;
+}
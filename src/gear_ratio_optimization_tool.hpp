@@ -0,0 +1,26 @@
+/*
+ * gear_ratio_optimization_tool.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef GEAR_RATIO_OPTIMIZATION_TOOL_HPP_
+#define GEAR_RATIO_OPTIMIZATION_TOOL_HPP_
+#include <ciso646>
+
+#include <string>
+
+/** Offline (headless) gear ratio optimization. Searches custom gear ratios (the differential ratio, plus the ratio and spacing of the
+ *  gears, while keeping the top gear ratio) for the vehicle spec in the given file, minimizing the given objective, which can be:
+ *  - "lap": the time of a standing-start lap on the course in the given file, driven at the vehicle's limits;
+ *  - "0-100": the time to go from 0 to 100 km/h;
+ *  - "quarter-mile": the time to run a quarter mile.
+ *  Each candidate is evaluated by simulating the vehicle's Mechanics step by step (on the course's slopes, when driving a lap), and
+ *  candidates are evaluated in parallel, with the given number of threads (0 means one per core). The search is done on a grid that is
+ *  refined around the best candidate over a few rounds. The best ratios are written to the given file (and to the standard output), as
+ *  a .properties fragment that can be pasted in the vehicle's file. Returns the program's exit status. */
+int runGearRatioOptimizationTool(const std::string& vehicleFilename, const std::string& objective, const std::string& courseFilename,
+	unsigned simulationType, unsigned threadCount, const std::string& outputFilename);
+
+#endif /* GEAR_RATIO_OPTIMIZATION_TOOL_HPP_ */
@@ -0,0 +1,209 @@
+/*
+ * image_cache.cpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#include "image_cache.hpp"
+
+#include "futil/language.hpp"
+
+#include <map>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+
+using std::string;
+using std::map;
+using std::vector;
+using fgeal::Image;
+using fgeal::Graphics;
+using fgeal::Color;
+
+namespace  // anonymous
+{
+	struct CacheEntry
+	{
+		Image* image;
+		unsigned referenceCount;
+		unsigned long size;  // estimated memory taken by the image, in bytes
+		unsigned long lastReleaseOrder;  // when this entry was last released, for eviction
+	};
+
+	map<string, CacheEntry> entries;
+
+	// reverse index, so that releasing doesn't need to search all entries
+	map<Image*, string> filenamesByImage;
+
+	unsigned long releaseCounter = 0, memoryBudget = 64*1024*1024, unreferencedMemoryUsage = 0, memoryUsage = 0;
+	bool retainingUnreferenced = true;
+}
+
+// frees the least recently released, unreferenced images, until they fit within the given budget
+static void evictUnreferenced(unsigned long budget)
+{
+	while(unreferencedMemoryUsage > budget)
+	{
+		map<string, CacheEntry>::iterator oldest = entries.end();
+		for(map<string, CacheEntry>::iterator it = entries.begin(); it != entries.end(); ++it)
+			if(it->second.referenceCount == 0 and (oldest == entries.end() or it->second.lastReleaseOrder < oldest->second.lastReleaseOrder))
+				oldest = it;
+
+		if(oldest == entries.end())  // should not happen
+			return;
+
+		unreferencedMemoryUsage -= oldest->second.size;
+		memoryUsage -= oldest->second.size;
+		filenamesByImage.erase(oldest->second.image);
+		delete oldest->second.image;
+		entries.erase(oldest);
+	}
+}
+
+string ImageCache::getCanonicalFilename(const string& filename)
+{
+	const bool isAbsolute = not filename.empty() and (filename[0] == '/' or filename[0] == '\\');
+	vector<string> components;
+	string component;
+	for(unsigned i = 0; i <= filename.size(); i++)
+	{
+		if(i == filename.size() or filename[i] == '/' or filename[i] == '\\')
+		{
+			if(component == "..")
+			{
+				if(not components.empty() and components.back() != "..")
+					components.pop_back();
+				else if(not isAbsolute)
+					components.push_back(component);
+			}
+			else if(not component.empty() and component != ".")
+				components.push_back(component);
+
+			component.clear();
+		}
+		else component += filename[i];
+	}
+
+	string canonical = isAbsolute? "/" : "";
+	for(unsigned i = 0; i < components.size(); i++)
+		canonical += (i > 0? "/" : "") + components[i];
+
+	return canonical;
+}
+
+// adds a reference to the given entry
+static Image* addReference(CacheEntry& entry)
+{
+	if(entry.referenceCount == 0)
+		unreferencedMemoryUsage -= entry.size;
+
+	entry.referenceCount++;
+	return entry.image;
+}
+
+// adds an entry for the given image, with no references
+static CacheEntry& addEntry(const string& key, Image* image)
+{
+	const CacheEntry entry = { image, 0, 4ul * image->getWidth() * image->getHeight(), 0 };
+	filenamesByImage[image] = key;
+	memoryUsage += entry.size;
+	unreferencedMemoryUsage += entry.size;  // until referenced
+	return entries.insert(std::make_pair(key, entry)).first->second;
+}
+
+Image* ImageCache::acquire(const string& filename)
+{
+	const string canonicalFilename = getCanonicalFilename(filename);
+	map<string, CacheEntry>::iterator it = entries.find(canonicalFilename);
+	if(it == entries.end())
+		return addReference(addEntry(canonicalFilename, new Image(canonicalFilename)));
+
+	return addReference(it->second);
+}
+
+Image* ImageCache::acquireMipLevel(const string& filename, unsigned level, unsigned cellWidth, unsigned cellHeight)
+{
+	if(level == 0)
+		return acquire(filename);
+
+	// levels are keyed by filename, level and cell size (the same file may be used with different cell sizes)
+	std::ostringstream keyStream;
+	keyStream << getCanonicalFilename(filename) << "|mip" << level << '|' << cellWidth << 'x' << cellHeight;
+	const string key = keyStream.str();
+
+	map<string, CacheEntry>::iterator it = entries.find(key);
+	if(it != entries.end())
+		return addReference(it->second);
+
+	Image* const previousLevelImage = acquireMipLevel(filename, level-1, cellWidth, cellHeight);
+	if(cellWidth == 0 or cellHeight == 0)  // the image is a single cell, whose size on level 0 is the image's size
+	{
+		Image* const originalImage = acquire(filename);
+		if(cellWidth == 0) cellWidth = originalImage->getWidth();
+		if(cellHeight == 0) cellHeight = originalImage->getHeight();
+		release(originalImage);
+	}
+
+	// the ratio between cell sizes (instead of just a half), so that cells stay aligned even with odd sizes
+	const float scaleX = getMipLevelCellSize(cellWidth, level) / static_cast<float>(getMipLevelCellSize(cellWidth, level-1)),
+				scaleY = getMipLevelCellSize(cellHeight, level) / static_cast<float>(getMipLevelCellSize(cellHeight, level-1));
+
+	const int width = std::max(1, static_cast<int>(ceil(previousLevelImage->getWidth() * scaleX))),
+			  height = std::max(1, static_cast<int>(ceil(previousLevelImage->getHeight() * scaleY)));
+
+	Image* const image = new Image(width, height);
+	Graphics::setDrawTarget(image);
+	Graphics::drawFilledRectangle(0, 0, width, height, Color::_TRANSPARENT);
+	previousLevelImage->drawScaled(0, 0, scaleX, scaleY);
+	Graphics::setDefaultDrawTarget();
+
+	addReference(addEntry(key, image));
+	release(previousLevelImage);  // kept cached (if within budget), as it's likely to be used as well
+	return image;
+}
+
+void ImageCache::retain(Image* image)
+{
+	map<Image*, string>::iterator filenameIt = filenamesByImage.find(image);
+	if(filenameIt != filenamesByImage.end())
+		addReference(entries.find(filenameIt->second)->second);
+}
+
+void ImageCache::release(Image* image)
+{
+	map<Image*, string>::iterator filenameIt = filenamesByImage.find(image);
+	if(filenameIt == filenamesByImage.end())
+		return;
+
+	CacheEntry& entry = entries.find(filenameIt->second)->second;
+	if(entry.referenceCount > 0 and --entry.referenceCount == 0)
+	{
+		entry.lastReleaseOrder = ++releaseCounter;
+		unreferencedMemoryUsage += entry.size;
+		evictUnreferenced(retainingUnreferenced? memoryBudget : 0);
+	}
+}
+
+void ImageCache::setMemoryBudget(unsigned long bytes)
+{
+	memoryBudget = bytes;
+	evictUnreferenced(retainingUnreferenced? memoryBudget : 0);
+}
+
+unsigned long ImageCache::getMemoryUsage()
+{
+	return memoryUsage;
+}
+
+void ImageCache::purge()
+{
+	evictUnreferenced(0);
+}
+
+void ImageCache::shutdown()
+{
+	retainingUnreferenced = false;
+	evictUnreferenced(0);
+}
@@ -0,0 +1,63 @@
+/*
+ * image_cache.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef GFX_IMAGE_CACHE_HPP_
+#define GFX_IMAGE_CACHE_HPP_
+#include <ciso646>
+
+#include "fgeal/fgeal.hpp"
+
+#include <string>
+
+/** A process-wide, reference-counted cache of loaded images, keyed by canonical filename (so that "a/./b.png" and "a/c/../b.png" are
+ *  the same file), so that an image file is loaded (and decoded) only once, no matter how many states or vehicles use it. Images that
+ *  are no longer referenced are kept while they fit within a memory budget (the least recently released being freed first), so that
+ *  moving back and forth between menus and races does not load them again.
+ *  Note that images may be textures owned by the graphics backend, so this cache must only be used from the main thread. */
+class ImageCache
+{
+	ImageCache();  // not instantiable
+
+	public:
+
+	/** Returns the image loaded from the given file, loading it only if not already cached. Throws an exception if the file can't be
+	 *  loaded. Each call must be matched by a call to release(). */
+	static fgeal::Image* acquire(const std::string& filename);
+
+	/** Returns a prescaled (downsized) version of the image in the given file, for drawing it small (like a mipmap level), generating it only
+	 *  if not already cached. Each level is half the size of the previous one (level 0 is the image itself), as if the image were a grid of
+	 *  cells with the given size (halved on each level), so that the cells of a sprite sheet stay aligned (if zero, the image is one cell).
+	 *  Levels are generated from each other by drawing, so this must not be called while drawing to a target other than the default one.
+	 *  Throws an exception if the file can't be loaded. Each call must be matched by a call to release(). */
+	static fgeal::Image* acquireMipLevel(const std::string& filename, unsigned level, unsigned cellWidth=0, unsigned cellHeight=0);
+
+	/** Returns the size of the cells on the given mipmap level (see acquireMipLevel()), given their size on level 0. */
+	inline static unsigned getMipLevelCellSize(unsigned cellSize, unsigned level) { return (cellSize >> level) > 0? (cellSize >> level) : 1; }
+
+	/** Adds a reference to the given cached image (obtained from acquire()), which must also be matched by a call to release(). */
+	static void retain(fgeal::Image* image);
+
+	/** Removes a reference to the given cached image. Images not obtained from acquire() (or null) are ignored. */
+	static void release(fgeal::Image* image);
+
+	/** Sets how much memory (in bytes, estimated from the images' sizes) unreferenced images may take. Default is 64MB. */
+	static void setMemoryBudget(unsigned long bytes);
+
+	/** Returns the estimated memory taken by cached images (in bytes), referenced or not. */
+	static unsigned long getMemoryUsage();
+
+	/** Frees all cached images that are not referenced anymore. */
+	static void purge();
+
+	/** Frees all unreferenced images and stops keeping images once they are unreferenced. Should be called before finalizing fgeal. */
+	static void shutdown();
+
+	/** Returns the canonical form of the given filename (forward slashes only, with no redundant "." or ".." components). */
+	static std::string getCanonicalFilename(const std::string& filename);
+};
+
+#endif /* GFX_IMAGE_CACHE_HPP_ */
@@ -0,0 +1,96 @@
+/*
+ * image_prefetcher.cpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#include "image_prefetcher.hpp"
+
+#include "image_cache.hpp"
+
+#include "futil/language.hpp"
+
+#include <algorithm>
+
+using std::string;
+using std::vector;
+using std::deque;
+using std::map;
+using fgeal::Image;
+
+ImagePrefetcher::ImagePrefetcher()
+: pendingFilenames(), heldImages()
+{}
+
+ImagePrefetcher::~ImagePrefetcher()
+{
+	clear();
+}
+
+void ImagePrefetcher::setWindow(const vector<string>& filenames)
+{
+	deque<string> newPendingFilenames;
+	map<string, Image*> newHeldImages;
+	for(unsigned i = 0; i < filenames.size(); i++)
+	{
+		const string filename = ImageCache::getCanonicalFilename(filenames[i]);
+		if(newHeldImages.count(filename) > 0 or std::find(newPendingFilenames.begin(), newPendingFilenames.end(), filename) != newPendingFilenames.end())
+			continue;
+
+		const map<string, Image*>::iterator held = heldImages.find(filename);
+		if(held != heldImages.end())
+		{
+			newHeldImages.insert(*held);
+			heldImages.erase(held);
+		}
+		else
+			newPendingFilenames.push_back(filename);
+	}
+
+	// whatever is left held is out of the window now
+	for(map<string, Image*>::iterator it = heldImages.begin(); it != heldImages.end(); ++it)
+		ImageCache::release(it->second);
+
+	heldImages.swap(newHeldImages);
+	pendingFilenames.swap(newPendingFilenames);
+}
+
+bool ImagePrefetcher::process(float timeBudget)
+{
+	const double deadline = fgeal::uptime() + timeBudget;
+	while(not pendingFilenames.empty())
+	{
+		const string filename = pendingFilenames.front();
+		pendingFilenames.pop_front();
+		Image* image = null;
+		try { image = ImageCache::acquire(filename); }
+		catch(...) {}  // left for whoever actually needs it to report
+
+		if(image != null)
+			heldImages[filename] = image;
+
+		if(fgeal::uptime() >= deadline)
+			break;
+	}
+	return isDone();
+}
+
+bool ImagePrefetcher::isDone() const
+{
+	return pendingFilenames.empty();
+}
+
+unsigned ImagePrefetcher::getPendingCount() const
+{
+	return pendingFilenames.size();
+}
+
+void ImagePrefetcher::clear()
+{
+	for(map<string, Image*>::iterator it = heldImages.begin(); it != heldImages.end(); ++it)
+		ImageCache::release(it->second);
+
+	heldImages.clear();
+	pendingFilenames.clear();
+}
@@ -0,0 +1,56 @@
+/*
+ * image_prefetcher.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef GFX_IMAGE_PREFETCHER_HPP_
+#define GFX_IMAGE_PREFETCHER_HPP_
+#include <ciso646>
+
+#include "fgeal/fgeal.hpp"
+
+#include <deque>
+#include <map>
+#include <vector>
+#include <string>
+
+/** Loads a window of image files into the ImageCache ahead of time, a few per frame, so that they are already cached when acquired. The
+ *  window is replaced as a whole (i.e. when a selection moves): files that left the window are dropped from the queue if not yet loaded
+ *  (or released if loaded), so that stale requests don't pile up when the window moves fast. Images in the window are held (referenced)
+ *  until they leave it or clear() is called. Like the ImageCache, this must only be used from the main thread. */
+class ImagePrefetcher
+{
+	// the files of the window not yet loaded, in priority order (canonical filenames)
+	std::deque<std::string> pendingFilenames;
+
+	// the images of the window already loaded, keyed by canonical filename
+	std::map<std::string, fgeal::Image*> heldImages;
+
+	ImagePrefetcher(const ImagePrefetcher&);  // not copyable
+	ImagePrefetcher& operator=(const ImagePrefetcher&);
+
+	public:
+
+	ImagePrefetcher();
+	~ImagePrefetcher();
+
+	/** Sets the files to be prefetched, in priority order, replacing the previous window. Repeated filenames are ignored. */
+	void setWindow(const std::vector<std::string>& filenames);
+
+	/** Loads pending files until the given time budget (in seconds) is spent; at least one file is loaded, if any. Returns true if the
+	 *  whole window is loaded. Files that fail to load are skipped, so that the error surfaces when they are actually acquired. */
+	bool process(float timeBudget);
+
+	/** Returns true if all files of the window are loaded. */
+	bool isDone() const;
+
+	/** Returns how many files of the window are not yet loaded. */
+	unsigned getPendingCount() const;
+
+	/** Empties the window, releasing held images (which stay cached while they fit in the ImageCache's budget). */
+	void clear();
+};
+
+#endif /* GFX_IMAGE_PREFETCHER_HPP_ */
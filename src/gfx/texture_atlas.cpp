@@ -0,0 +1,141 @@
+/*
+ * texture_atlas.cpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#include "texture_atlas.hpp"
+
+#include "futil/language.hpp"
+
+#include <algorithm>
+
+using std::vector;
+using std::map;
+using fgeal::Image;
+using fgeal::Sprite;
+using fgeal::Graphics;
+using fgeal::Color;
+
+// the gap between packed images, so that filtering (when drawn scaled) doesn't blend pixels of neighbouring images
+static const int PADDING = 2;
+
+namespace  // anonymous
+{
+	struct TallerImageComparator
+	{
+		bool operator()(Image* image1, Image* image2) const
+		{
+			return image1->getHeight() > image2->getHeight();
+		}
+	};
+}
+
+TextureAtlas::TextureAtlas(unsigned pageWidth, unsigned pageHeight)
+: pageWidth(pageWidth), pageHeight(pageHeight), pages(), regions()
+{}
+
+TextureAtlas::~TextureAtlas()
+{
+	clear();
+}
+
+void TextureAtlas::pack(const vector<Image*>& images)
+{
+	vector<Image*> pendingImages;
+	for(unsigned i = 0; i < images.size(); i++)
+		if(images[i] != null and regions.find(images[i]) == regions.end()
+		and std::find(pendingImages.begin(), pendingImages.end(), images[i]) == pendingImages.end()
+		and images[i]->getWidth() <= (int) pageWidth and images[i]->getHeight() <= (int) pageHeight)
+			pendingImages.push_back(images[i]);
+
+	if(pendingImages.empty())
+		return;
+
+	std::stable_sort(pendingImages.begin(), pendingImages.end(), TallerImageComparator());
+
+	// place images in shelves, left to right, starting a new shelf when a row is full and a new page when a page is full
+	const unsigned firstPageIndex = pages.size();
+	vector<int> pageUsedWidths(1, 0), pageUsedHeights(1, 0);
+	int shelfX = 0, shelfY = 0, shelfHeight = 0;
+	for(unsigned i = 0; i < pendingImages.size(); i++)
+	{
+		const int width = pendingImages[i]->getWidth(), height = pendingImages[i]->getHeight();
+		if(shelfX + width > (int) pageWidth)
+		{
+			shelfY += shelfHeight + PADDING;
+			shelfX = shelfHeight = 0;
+		}
+		if(shelfY + height > (int) pageHeight)
+		{
+			pageUsedWidths.push_back(0);
+			pageUsedHeights.push_back(0);
+			shelfX = shelfY = shelfHeight = 0;
+		}
+
+		const Region region = { firstPageIndex + (unsigned) pageUsedWidths.size()-1, shelfX, shelfY, width, height };
+		regions[pendingImages[i]] = region;
+
+		shelfX += width + PADDING;
+		shelfHeight = std::max(shelfHeight, height);
+		pageUsedWidths.back() = std::max(pageUsedWidths.back(), region.x + width);
+		pageUsedHeights.back() = std::max(pageUsedHeights.back(), region.y + height);
+	}
+
+	// pages are only as large as needed
+	for(unsigned p = 0; p < pageUsedWidths.size(); p++)
+	{
+		Image* page = new Image(pageUsedWidths[p], pageUsedHeights[p]);
+		Graphics::setDrawTarget(page);
+		Graphics::drawFilledRectangle(0, 0, page->getWidth(), page->getHeight(), Color::_TRANSPARENT);
+		for(unsigned i = 0; i < pendingImages.size(); i++)
+		{
+			const Region& region = regions[pendingImages[i]];
+			if(region.pageIndex == firstPageIndex + p)
+				pendingImages[i]->draw(region.x, region.y);
+		}
+		Graphics::setDefaultDrawTarget();
+		pages.push_back(page);
+	}
+}
+
+const TextureAtlas::Region* TextureAtlas::find(const Image* image) const
+{
+	const map<const Image*, Region>::const_iterator it = regions.find(image);
+	return it != regions.end()? &it->second : null;
+}
+
+bool TextureAtlas::relocate(Sprite& sprite) const
+{
+	const Region* region = find(sprite.image);
+	if(region == null)
+		return false;
+
+	for(unsigned i = 0; i < sprite.frameSequence.size(); i++)
+	{
+		sprite.frameSequence[i].x += region->x;
+		sprite.frameSequence[i].y += region->y;
+	}
+	sprite.image = pages[region->pageIndex];
+	return true;
+}
+
+unsigned TextureAtlas::getPageIndex(const Image* page) const
+{
+	return std::find(pages.begin(), pages.end(), page) - pages.begin();
+}
+
+unsigned TextureAtlas::getPageCount() const
+{
+	return pages.size();
+}
+
+void TextureAtlas::clear()
+{
+	for(unsigned i = 0; i < pages.size(); i++)
+		delete pages[i];
+
+	pages.clear();
+	regions.clear();
+}
@@ -0,0 +1,70 @@
+/*
+ * texture_atlas.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef GFX_TEXTURE_ATLAS_HPP_
+#define GFX_TEXTURE_ATLAS_HPP_
+#include <ciso646>
+
+#include "fgeal/fgeal.hpp"
+#include "fgeal/extra/sprite.hpp"
+
+#include <vector>
+#include <map>
+
+/** A set of images (pages) into which many smaller images (i.e. sprite sheets) are copied, so that they can all be drawn from a few
+ *  textures, instead of switching textures between each of them. Images are packed in rows ("shelves"), tallest first. The pages are
+ *  owned by the atlas, while the packed images are only copied (and can be released afterwards). Sprites drawn from a packed image can
+ *  be moved to the atlas with relocate(). Like the ImageCache, this must only be used from the main thread. */
+class TextureAtlas
+{
+	public:
+
+	/** Where an image was packed. */
+	struct Region
+	{
+		unsigned pageIndex;
+		int x, y, width, height;
+	};
+
+	static const unsigned DEFAULT_PAGE_SIZE = 2048;
+
+	private:
+
+	unsigned pageWidth, pageHeight;
+	std::vector<fgeal::Image*> pages;
+	std::map<const fgeal::Image*, Region> regions;
+
+	TextureAtlas(const TextureAtlas&);  // not copyable
+	TextureAtlas& operator=(const TextureAtlas&);
+
+	public:
+
+	TextureAtlas(unsigned pageWidth=DEFAULT_PAGE_SIZE, unsigned pageHeight=DEFAULT_PAGE_SIZE);
+	~TextureAtlas();
+
+	/** Packs the given images into new pages. Images already packed, repeated or too large to fit in a page are skipped. Each call starts
+	 *  new pages, so it's best to pack all images at once. Images are copied by drawing, so this must not be called while drawing to a
+	 *  target other than the default one. */
+	void pack(const std::vector<fgeal::Image*>& images);
+
+	/** Returns the region where the given image was packed, or null if it wasn't packed. */
+	const Region* find(const fgeal::Image* image) const;
+
+	/** Makes the given sprite draw from the page where its image was packed (offsetting its frames accordingly). Returns false (leaving
+	 *  the sprite as is) if its image wasn't packed. The atlas must outlive the sprite (or at least its drawing). */
+	bool relocate(fgeal::Sprite& sprite) const;
+
+	/** Returns the index of the given page, or the page count if it isn't a page of this atlas. */
+	unsigned getPageIndex(const fgeal::Image* page) const;
+
+	unsigned getPageCount() const;
+
+	/** Deletes all pages (sprites relocated to them must not be drawn anymore). */
+	void clear();
+};
+
+#endif /* GFX_TEXTURE_ATLAS_HPP_ */
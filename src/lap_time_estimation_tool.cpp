@@ -0,0 +1,186 @@
+/*
+ * lap_time_estimation_tool.cpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#include "lap_time_estimation_tool.hpp"
+
+#include "carse_logic.hpp"
+#include "course.hpp"
+#include "vehicle.hpp"
+#include "pseudo3d_race_state.hpp"
+#include "tool_util.hpp"
+
+#include "racing/lap_time_estimate.hpp"
+
+#include "fgeal/filesystem.hpp"
+#include "futil/string_actions.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <stdexcept>
+
+#include <cstdlib>
+#include <ctime>
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+using futil::ends_with;
+
+namespace  // anonymous
+{
+	// a vehicle to be measured with a given simulation type
+	struct EstimatedVehicle
+	{
+		string category, filename, name;
+		Mechanics body;
+		float maximumStrafeSpeed;
+
+		EstimatedVehicle(const string& category, const string& filename, const string& name, const Mechanics& body)
+		: category(category), filename(filename), name(name), body(body), maximumStrafeSpeed(Pseudo3DRaceState::getMaximumStrafeSpeed(body)) {}
+	};
+
+	// the estimate of a vehicle on a course
+	struct EstimationResult
+	{
+		unsigned vehicleIndex, courseIndex;
+		LapTimeEstimate estimate;
+	};
+}
+
+// loads all vehicle specs in the given folder and adds one entry for each of them and each simulation type
+static void addEstimatedVehicles(vector<EstimatedVehicle>& vehicles, const string& folder, const string& category)
+{
+	const vector<string> filenames = CarseLogic::getPropertiesFilenamesWithinDirectory(folder);
+	for(unsigned i = 0; i < filenames.size(); i++)
+	{
+		Pseudo3DVehicle::Spec spec;
+		try { spec.loadFromFile(filenames[i]); }
+		catch(const std::exception& e) { cout << "skipping " << filenames[i] << ": " << e.what() << endl; continue; }
+
+		Pseudo3DVehicle vehicle;
+		vehicle.setSpec(spec);
+		vehicle.body.tireFrictionFactor = Pseudo3DRaceState::TIRE_FRICTION_COEFFICIENT_DRY_ASPHALT;
+		vehicle.body.rollingResistanceFactor = Pseudo3DRaceState::ROLLING_RESISTANCE_COEFFICIENT_DRY_ASPHALT;
+		for(unsigned type = 0; type < Mechanics::SIMULATION_TYPE_COUNT; type++)
+		{
+			vehicle.body.simulationType = static_cast<Mechanics::SimulationType>(type);
+			vehicles.push_back(EstimatedVehicle(category, filenames[i], spec.name, vehicle.body));
+		}
+	}
+}
+
+static vector<Pseudo3DCourse::Spec> loadCourses()
+{
+	vector<Pseudo3DCourse::Spec> courses;
+	const vector<string> filenames = fgeal::filesystem::getFilenamesWithinDirectory(CarseLogic::COURSES_FOLDER);
+	for(unsigned i = 0; i < filenames.size(); i++)
+	{
+		if(not ends_with(filenames[i], ".properties"))
+			continue;
+
+		Pseudo3DCourse::Spec spec(0, 0);
+		try { spec.loadFromFile(filenames[i]); }
+		catch(const std::exception& e) { cout << "skipping course " << filenames[i] << ": " << e.what() << endl; continue; }
+
+		if(not spec.lines.empty())
+			courses.push_back(spec);
+	}
+	return courses;
+}
+
+static void writeCsv(std::ostream& out, const vector<EstimationResult>& results, const vector<EstimatedVehicle>& vehicles, const vector<Pseudo3DCourse::Spec>& courses)
+{
+	out << "category,filename,name,course,simulation_type,lap_time_s,average_speed_kph,top_speed_kph,minimum_speed_kph\n";
+	for(unsigned i = 0; i < results.size(); i++)
+	{
+		const EstimatedVehicle& vehicle = vehicles[results[i].vehicleIndex];
+		const LapTimeEstimate& estimate = results[i].estimate;
+		const bool completed = estimate.lapTime >= 0;
+		out << vehicle.category << ',' << escapeCsv(vehicle.filename) << ',' << escapeCsv(vehicle.name)
+			<< ',' << escapeCsv(courses[results[i].courseIndex].toString()) << ',' << SIMULATION_TYPE_NAMES[vehicle.body.simulationType]
+			<< ',' << formatFigure(estimate.lapTime, "")
+			<< ',' << (completed? formatFigure(estimate.averageSpeed * MPS_TO_KPH, "") : "")
+			<< ',' << (completed? formatFigure(estimate.topSpeed * MPS_TO_KPH, "") : "")
+			<< ',' << (completed? formatFigure(estimate.minimumSpeed * MPS_TO_KPH, "") : "")
+			<< "\n";
+	}
+}
+
+static void writeJson(std::ostream& out, const vector<EstimationResult>& results, const vector<EstimatedVehicle>& vehicles, const vector<Pseudo3DCourse::Spec>& courses)
+{
+	out << "[\n";
+	for(unsigned i = 0; i < results.size(); i++)
+	{
+		const EstimatedVehicle& vehicle = vehicles[results[i].vehicleIndex];
+		const LapTimeEstimate& estimate = results[i].estimate;
+		const bool completed = estimate.lapTime >= 0;
+		out << "  {"
+			<< "\"category\": " << escapeJson(vehicle.category)
+			<< ", \"filename\": " << escapeJson(vehicle.filename)
+			<< ", \"name\": " << escapeJson(vehicle.name)
+			<< ", \"course\": " << escapeJson(courses[results[i].courseIndex].toString())
+			<< ", \"simulation_type\": \"" << SIMULATION_TYPE_NAMES[vehicle.body.simulationType] << "\""
+			<< ", \"lap_time_s\": " << formatFigure(estimate.lapTime, "null")
+			<< ", \"average_speed_kph\": " << (completed? formatFigure(estimate.averageSpeed * MPS_TO_KPH, "null") : "null")
+			<< ", \"top_speed_kph\": " << (completed? formatFigure(estimate.topSpeed * MPS_TO_KPH, "null") : "null")
+			<< ", \"minimum_speed_kph\": " << (completed? formatFigure(estimate.minimumSpeed * MPS_TO_KPH, "null") : "null")
+			<< "}" << (i+1 < results.size()? "," : "") << "\n";
+	}
+	out << "]\n";
+}
+
+int runLapTimeEstimationTool(const string& outputFilename)
+{
+	CarseLogic::getInstance().loadPresets();  // vehicle specs may refer to preset engine sound profiles
+
+	const vector<Pseudo3DCourse::Spec> courses = loadCourses();
+	if(courses.empty())
+	{
+		cout << "error: no courses to estimate lap times on" << endl;
+		return EXIT_FAILURE;
+	}
+
+	vector<EstimatedVehicle> vehicles;
+	addEstimatedVehicles(vehicles, CarseLogic::VEHICLES_FOLDER, "vehicle");
+	addEstimatedVehicles(vehicles, CarseLogic::TRAFFIC_FOLDER, "traffic");
+
+	cout << "estimating lap times of " << vehicles.size() << " vehicle/simulation type combinations on " << courses.size() << " course(s)..." << endl;
+
+	vector<EstimationResult> results;
+	const clock_t startTime = clock();
+	for(unsigned v = 0; v < vehicles.size(); v++)
+		for(unsigned c = 0; c < courses.size(); c++)
+		{
+			EstimationResult result;
+			result.vehicleIndex = v;
+			result.courseIndex = c;
+			result.estimate = LapTimeEstimate::estimate(courses[c], Pseudo3DRaceState::DEFAULT_COURSE_POSITION_FACTOR, vehicles[v].body, vehicles[v].maximumStrafeSpeed);
+			result.estimate.speed.clear();  // the speed trace is not written, no need to keep it
+			results.push_back(result);
+		}
+	const double elapsedTime = static_cast<double>(clock() - startTime) / CLOCKS_PER_SEC;
+
+	cout << "estimated " << results.size() << " lap(s) in " << elapsedTime * 1000 << "ms ("
+		 << (results.empty()? 0 : elapsedTime * 1000 / results.size()) << "ms per lap)" << endl;
+
+	std::ofstream out(outputFilename.c_str());
+	if(not out)
+	{
+		cout << "error: could not open " << outputFilename << " for writing" << endl;
+		return EXIT_FAILURE;
+	}
+
+	if(ends_with(outputFilename, ".json"))
+		writeJson(out, results, vehicles, courses);
+	else
+		writeCsv(out, results, vehicles, courses);
+
+	cout << "wrote lap time estimates to " << outputFilename << endl;
+	return EXIT_SUCCESS;
+}
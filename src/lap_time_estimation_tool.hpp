@@ -0,0 +1,20 @@
+/*
+ * lap_time_estimation_tool.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef LAP_TIME_ESTIMATION_TOOL_HPP_
+#define LAP_TIME_ESTIMATION_TOOL_HPP_
+#include <ciso646>
+
+#include <string>
+
+/** Offline (headless) lap time estimation. Estimates the lap time (as well as average, top and minimum speeds) of every vehicle (from
+ *  the vehicles and traffic folders) on every course, with each simulation type, using the quasi-steady-state estimator (see
+ *  LapTimeEstimate), and writes the results to the given file. If the filename ends with ".json", results are written as JSON,
+ *  otherwise as CSV. Returns the program's exit status. */
+int runLapTimeEstimationTool(const std::string& outputFilename);
+
+#endif /* LAP_TIME_ESTIMATION_TOOL_HPP_ */
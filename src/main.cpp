@@ -22,6 +22,10 @@
 #endif
 
 #include "race_only_args.hpp"
+#include "performance_analysis_tool.hpp"
+#include "physics_regression_tool.hpp"
+#include "lap_time_estimation_tool.hpp"
+#include "gear_ratio_optimization_tool.hpp"
 #include <tclap/CmdLine.h>
 
 #include "fgeal/fgeal.hpp"
@@ -66,9 +70,12 @@ namespace RaceOnlyArgs
 
 	ValueArg<unsigned> vehicleIndex("V", "vehicle", "When used in conjunction with the --race parameter, specifies the player vehicle, represented by its index", false, 0, "unsigned integer");
 	ValueArg<int> vehicleAlternateSpriteIndex("S", "vehicle-alternate-sprite", "When used in conjunction with the --vehicle parameter, specifies the alternate player vehicle sprite, represented by its index", false, -1, "integer");
-	ValueArg<unsigned> simulationType("P", "simulation-type", "When used in conjunction with the --race parameter, specifies simulation type, represented by its index", false, 0, "unsigned integer"),
+	ValueArg<unsigned> simulationType("P", "simulation-type", "When used in conjunction with the --race or --optimize-gear-ratios parameters, specifies simulation type, represented by its index", false, 0, "unsigned integer"),
 					   hudType("H", "hud", "When used in conjunction with the --race parameter, specifies HUD type, represented by its index", false, 0, "unsigned index");
 	SwitchArg imperialUnit("U", "imperial-units", "When used in conjunction with the --race parameter, uses imperial units instead of metric", false);
+	SwitchArg deterministicPhysics("Z", "deterministic-physics", "When used in conjunction with the --race parameter, runs physics in deterministic mode (fixed time step and seeded traffic placement), so that runs with the same inputs are identical", false);
+	ValueArg<unsigned> randomSeed("E", "seed", "When used in conjunction with the --deterministic-physics parameter, specifies the seed used for traffic placement", false, 0, "unsigned integer");
+	ValueArg<unsigned> opponentCount("N", "opponents", "When used in conjunction with the --race parameter, specifies the number of AI-driven opponents", false, 0, "unsigned integer");
 }
 
 int main(int argc, char** argv)
@@ -116,6 +123,36 @@ int main(int argc, char** argv)
 	cmd.add(RaceOnlyArgs::simulationType);
 	cmd.add(RaceOnlyArgs::hudType);
 	cmd.add(RaceOnlyArgs::imperialUnit);
+	cmd.add(RaceOnlyArgs::deterministicPhysics);
+	cmd.add(RaceOnlyArgs::randomSeed);
+	cmd.add(RaceOnlyArgs::opponentCount);
+
+	SwitchArg argAnalyzePerformance("A", "analyze-performance", "Don't start the game; instead, measure the performance of all vehicles (with each simulation type) and write the results to a file (see --analysis-output).", false);
+	cmd.add(argAnalyzePerformance);
+
+	SwitchArg argEstimateLapTimes("Q", "estimate-lap-times", "Don't start the game; instead, estimate the lap times of all vehicles on all courses (with each simulation type) and write the results to a file (see --analysis-output).", false);
+	cmd.add(argEstimateLapTimes);
+
+	ValueArg<string> argOptimizeGearRatios("Y", "optimize-gear-ratios", "Don't start the game; instead, search the gear ratios that minimize the given objective (see --optimization-objective) for the vehicle in the given file, and write them to a file (see --analysis-output).", false, "", "filename");
+	cmd.add(argOptimizeGearRatios);
+
+	ValueArg<string> argOptimizationObjective("I", "optimization-objective", "When used in conjunction with the --optimize-gear-ratios parameter, specifies the objective to minimize: 'lap' (lap time on the course given by --optimization-course), '0-100' (0 to 100 km/h time) or 'quarter-mile' (quarter mile time).", false, "lap", "objective");
+	cmd.add(argOptimizationObjective);
+
+	ValueArg<string> argOptimizationCourse("B", "optimization-course", "When used in conjunction with the --optimize-gear-ratios parameter, specifies the file of the course to optimize lap time on.", false, "", "filename");
+	cmd.add(argOptimizationCourse);
+
+	ValueArg<string> argAnalysisOutput("O", "analysis-output", "When used in conjunction with the --analyze-performance, --estimate-lap-times or --optimize-gear-ratios parameters, specifies the output file (by default, performance.csv, lap_times.csv or gear_ratios.properties, respectively). For the first two, if its extension is .json, results are written as JSON, otherwise as CSV.", false, "performance.csv", "filename");
+	cmd.add(argAnalysisOutput);
+
+	ValueArg<unsigned> argAnalysisThreads("J", "analysis-threads", "When used in conjunction with the --analyze-performance or --optimize-gear-ratios parameters, specifies the number of threads to use (0 means one per core).", false, 0, "unsigned integer");
+	cmd.add(argAnalysisThreads);
+
+	SwitchArg argPhysicsRegression("G", "physics-regression", "Don't start the game; instead, drive all vehicles through fixed input scripts on all courses (with each simulation type), compare the resulting traces against the golden traces in data/physics_traces and report the time spent per physics step. Also checks (and times) each vehicle's torque curve lookups against a linear scan of the curve, and each integration method's accuracy at its maximum time step.", false);
+	cmd.add(argPhysicsRegression);
+
+	SwitchArg argPhysicsRegressionRecord("K", "physics-regression-record", "Same as --physics-regression, but instead of comparing, (re)records the golden traces. Use only when a change in physics behavior is intended.", false);
+	cmd.add(argPhysicsRegressionRecord);
 
 	cmd.reverseArgList();
 	cmd.parse(argc, argv);
@@ -148,6 +185,39 @@ int main(int argc, char** argv)
 		cout << "failed to initialize: " << e.what() << endl;
 	}
 
+	// headless modes, no display needed
+	if(argAnalyzePerformance.isSet() or argEstimateLapTimes.isSet() or argOptimizeGearRatios.isSet() or argPhysicsRegression.isSet() or argPhysicsRegressionRecord.isSet())
+	{
+		int status = EXIT_FAILURE;
+		try
+		{
+			if(argAnalyzePerformance.isSet())
+				status = runPerformanceAnalysisTool(argAnalysisOutput.getValue(), argAnalysisThreads.getValue());
+			else if(argEstimateLapTimes.isSet())
+				status = runLapTimeEstimationTool(argAnalysisOutput.isSet()? argAnalysisOutput.getValue() : "lap_times.csv");
+			else if(argOptimizeGearRatios.isSet())
+				status = runGearRatioOptimizationTool(argOptimizeGearRatios.getValue(), argOptimizationObjective.getValue(), argOptimizationCourse.getValue(),
+						RaceOnlyArgs::simulationType.getValue(), argAnalysisThreads.getValue(), argAnalysisOutput.isSet()? argAnalysisOutput.getValue() : "gear_ratios.properties");
+			else
+				status = runPhysicsRegressionTool(argPhysicsRegressionRecord.isSet());
+		}
+		catch(const std::exception& e)
+		{
+			cout << "headless tool failed: " << e.what() << endl;
+		}
+
+		try
+		{
+			fgeal::finalize();
+		}
+		catch (const fgeal::AdapterException& e)
+		{
+			cout << "failed to deinitialize: " << e.what() << endl;
+		}
+
+		return status;
+	}
+
 	Display::Options options;
 	options.title = "carse";
 	options.iconFilename = "assets/carse-icon.png";
@@ -9,6 +9,8 @@
 
 #include "carse_game.hpp"
 
+#include "gfx/image_cache.hpp"
+
 #include <cmath>
 
 using std::string;
@@ -33,12 +35,12 @@ MainMenuRetroLayoutState::MainMenuRetroLayoutState(CarseGame* game)
 
 MainMenuRetroLayoutState::~MainMenuRetroLayoutState()
 {
-	if(imgBackground != null) delete imgBackground;
-	if(imgRace != null) delete imgRace;
-	if(imgExit != null) delete imgExit;
-	if(imgSettings != null) delete imgSettings;
-	if(imgCourse != null) delete imgCourse;
-	if(imgVehicle != null) delete imgVehicle;
+	ImageCache::release(imgBackground);
+	ImageCache::release(imgRace);
+	ImageCache::release(imgExit);
+	ImageCache::release(imgSettings);
+	ImageCache::release(imgCourse);
+	ImageCache::release(imgVehicle);
 	if(fntTitle != null) delete fntTitle;
 	if(fntMain != null) delete fntMain;
 }
@@ -51,10 +53,10 @@ void MainMenuRetroLayoutState::initialize()
 	vecStrItems.push_back("Options");
 	vecStrItems.push_back("Exit");
 
-	imgBackground = new Image("assets/bg-main.jpg");
-	imgRace = new Image("assets/race.png");
-	imgExit = new Image("assets/exit.png");
-	imgSettings = new Image("assets/settings.png");
+	imgBackground = ImageCache::acquire("assets/bg-main.jpg");
+	imgRace = ImageCache::acquire("assets/race.png");
+	imgExit = ImageCache::acquire("assets/exit.png");
+	imgSettings = ImageCache::acquire("assets/settings.png");
 
 	// loan some shared resources
 	sndCursorMove = &game.sharedResources->sndCursorMove;
@@ -116,20 +118,18 @@ void MainMenuRetroLayoutState::onEnter()
 
 	selectedItemIndex = 0;
 
-	if(imgCourse != null)
-		delete imgCourse;
-
-	imgCourse = new Image(game.logic.getNextCourse().previewFilename.empty()? "assets/portrait-circuit.png" : game.logic.getNextCourse().previewFilename);
+	// previews are usually the same as last time, and thus still cached
+	ImageCache::release(imgCourse);
+	imgCourse = ImageCache::acquire(game.logic.getNextCourse().previewFilename.empty()? "assets/portrait-circuit.png" : game.logic.getNextCourse().previewFilename);
 
-	if(imgVehicle != null)
-		delete imgVehicle;
+	ImageCache::release(imgVehicle);
 
 	const Pseudo3DVehicleAnimationSpec& vspec = (
 		game.logic.getPickedVehicleAlternateSpriteIndex() == -1? game.logic.getPickedVehicle().sprite
 															   : game.logic.getPickedVehicle().alternateSprites[game.logic.getPickedVehicleAlternateSpriteIndex()]
 	);
 
-	imgVehicle = new Image(vspec.sheetFilename);
+	imgVehicle = ImageCache::acquire(vspec.sheetFilename);
 	scaleVehiclePreview.x = vspec.scale.x * display.getWidth() * 0.0037f;
 	scaleVehiclePreview.y = vspec.scale.y * display.getWidth() * 0.0037f;
 	rtSrcVehiclePreview.x = rtSrcVehiclePreview.y = 0;
@@ -9,6 +9,8 @@
 
 #include "carse_game.hpp"
 
+#include "gfx/image_cache.hpp"
+
 using fgeal::Display;
 using fgeal::Image;
 using fgeal::Menu;
@@ -28,7 +30,7 @@ MainMenuSimpleListState::MainMenuSimpleListState(CarseGame* game)
 
 MainMenuSimpleListState::~MainMenuSimpleListState()
 {
-	if(imgBackground != null) delete imgBackground;
+	ImageCache::release(imgBackground);
 	if(fntTitle != null) delete fntTitle;
 }
 
@@ -44,7 +46,7 @@ void MainMenuSimpleListState::initialize()
 	menu.addEntry("Options");
 	menu.addEntry("Exit");
 
-	imgBackground = new Image("assets/options-bg.jpg");
+	imgBackground = ImageCache::acquire("assets/options-bg.jpg");
 
 	// loan some shared resources
 	sndCursorMove = &game.sharedResources->sndCursorMove;
@@ -10,6 +10,8 @@
 
 #include "util.hpp"
 
+#include "gfx/image_cache.hpp"
+
 using fgeal::Image;
 using fgeal::Font;
 using fgeal::Sound;
@@ -50,14 +52,14 @@ OptionsMenuState::~OptionsMenuState()
 {
 	if(fontTitle != null) delete fontTitle;
 	if(font != null) delete font;
-	if(background != null) delete background;
+	ImageCache::release(background);
 }
 
 void OptionsMenuState::initialize()
 {
 	Display& display = game.getDisplay();
 	const FontSizer fs(display.getHeight());
-	background = new Image("assets/options-bg.jpg");
+	background = ImageCache::acquire("assets/options-bg.jpg");
 	fontTitle = new Font(game.sharedResources->font2Path, fs(48));
 	font = new Font(game.sharedResources->font1Path, fs(16));
 
@@ -0,0 +1,156 @@
+/*
+ * performance_analysis_tool.cpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#include "performance_analysis_tool.hpp"
+
+#include "carse_logic.hpp"
+#include "vehicle.hpp"
+#include "tool_util.hpp"
+
+#include "automotive/performance_analysis.hpp"
+
+#include "futil/string_actions.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <stdexcept>
+
+#include <cstdlib>
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+using futil::ends_with;
+
+namespace  // anonymous
+{
+	// a vehicle to be measured with a given simulation type
+	struct AnalysisJob
+	{
+		string category, filename, name;
+		Mechanics body;
+		PerformanceAnalysis result;
+
+		AnalysisJob(const string& category, const string& filename, const string& name, const Mechanics& body)
+		: category(category), filename(filename), name(name), body(body), result() {}
+	};
+}
+
+// runs the given analysis job (called from worker threads, see runParallelJobs())
+static void runAnalysisJob(void* jobs, unsigned jobIndex)
+{
+	AnalysisJob& job = static_cast<vector<AnalysisJob>*>(jobs)->at(jobIndex);
+	job.result = PerformanceAnalysis::analyze(job.body);
+}
+
+// loads all vehicle specs in the given folder and adds one job for each of them and each simulation type
+static void addAnalysisJobs(vector<AnalysisJob>& jobs, const string& folder, const string& category)
+{
+	const vector<string> filenames = CarseLogic::getPropertiesFilenamesWithinDirectory(folder);
+	for(unsigned i = 0; i < filenames.size(); i++)
+	{
+		Pseudo3DVehicle::Spec spec;
+		try { spec.loadFromFile(filenames[i]); }
+		catch(const std::exception& e) { cout << "skipping " << filenames[i] << ": " << e.what() << endl; continue; }
+
+		Pseudo3DVehicle vehicle;
+		vehicle.setSpec(spec);
+		for(unsigned type = 0; type < Mechanics::SIMULATION_TYPE_COUNT; type++)
+		{
+			vehicle.body.simulationType = static_cast<Mechanics::SimulationType>(type);
+			jobs.push_back(AnalysisJob(category, filenames[i], spec.name, vehicle.body));
+		}
+	}
+}
+
+static void writeCsv(std::ostream& out, const vector<AnalysisJob>& jobs)
+{
+	unsigned maxGearCount = 0;
+	for(unsigned i = 0; i < jobs.size(); i++)
+		if(jobs[i].result.gearMaximumSpeed.size() > maxGearCount)
+			maxGearCount = jobs[i].result.gearMaximumSpeed.size();
+
+	out << "category,filename,name,simulation_type,acceleration_0_100kph_s,quarter_mile_s,quarter_mile_trap_speed_kph,top_speed_kph,top_speed_time_s";
+	for(unsigned g = 0; g < maxGearCount; g++)
+		out << ",gear_" << (g+1) << "_max_speed_kph";
+	out << "\n";
+
+	for(unsigned i = 0; i < jobs.size(); i++)
+	{
+		const AnalysisJob& job = jobs[i];
+		const PerformanceAnalysis& result = job.result;
+		out << job.category << ',' << escapeCsv(job.filename) << ',' << escapeCsv(job.name) << ',' << SIMULATION_TYPE_NAMES[job.body.simulationType]
+			<< ',' << formatFigure(result.acceleration0to100Time, "")
+			<< ',' << formatFigure(result.quarterMileTime, "")
+			<< ',' << formatFigure(result.quarterMileTrapSpeed * MPS_TO_KPH, "")
+			<< ',' << formatFigure(result.topSpeed * MPS_TO_KPH, "")
+			<< ',' << formatFigure(result.topSpeedTime, "");
+		for(unsigned g = 0; g < maxGearCount; g++)
+			out << ',' << (g < result.gearMaximumSpeed.size()? formatFigure(result.gearMaximumSpeed[g] * MPS_TO_KPH, "") : "");
+		out << "\n";
+	}
+}
+
+static void writeJson(std::ostream& out, const vector<AnalysisJob>& jobs)
+{
+	out << "[\n";
+	for(unsigned i = 0; i < jobs.size(); i++)
+	{
+		const AnalysisJob& job = jobs[i];
+		const PerformanceAnalysis& result = job.result;
+		out << "  {"
+			<< "\"category\": " << escapeJson(job.category)
+			<< ", \"filename\": " << escapeJson(job.filename)
+			<< ", \"name\": " << escapeJson(job.name)
+			<< ", \"simulation_type\": \"" << SIMULATION_TYPE_NAMES[job.body.simulationType] << "\""
+			<< ", \"acceleration_0_100kph_s\": " << formatFigure(result.acceleration0to100Time, "null")
+			<< ", \"quarter_mile_s\": " << formatFigure(result.quarterMileTime, "null")
+			<< ", \"quarter_mile_trap_speed_kph\": " << formatFigure(result.quarterMileTrapSpeed * MPS_TO_KPH, "null")
+			<< ", \"top_speed_kph\": " << formatFigure(result.topSpeed * MPS_TO_KPH, "null")
+			<< ", \"top_speed_time_s\": " << formatFigure(result.topSpeedTime, "null")
+			<< ", \"gear_max_speed_kph\": [";
+		for(unsigned g = 0; g < result.gearMaximumSpeed.size(); g++)
+			out << (g > 0? ", " : "") << formatFigure(result.gearMaximumSpeed[g] * MPS_TO_KPH, "null");
+		out << "]}" << (i+1 < jobs.size()? "," : "") << "\n";
+	}
+	out << "]\n";
+}
+
+int runPerformanceAnalysisTool(const string& outputFilename, unsigned threadCount)
+{
+	CarseLogic::getInstance().loadPresets();  // vehicle specs may refer to preset engine sound profiles
+
+	vector<AnalysisJob> jobs;
+	addAnalysisJobs(jobs, CarseLogic::VEHICLES_FOLDER, "vehicle");
+	addAnalysisJobs(jobs, CarseLogic::TRAFFIC_FOLDER, "traffic");
+
+	if(threadCount == 0)
+		threadCount = getProcessorCount();
+	if(threadCount > jobs.size())
+		threadCount = jobs.empty()? 1 : jobs.size();
+
+	cout << "analyzing " << jobs.size() << " vehicle/simulation type combinations with " << threadCount << " thread(s)..." << endl;
+
+	runParallelJobs(runAnalysisJob, &jobs, jobs.size(), threadCount);
+
+	std::ofstream out(outputFilename.c_str());
+	if(not out)
+	{
+		cout << "error: could not open " << outputFilename << " for writing" << endl;
+		return EXIT_FAILURE;
+	}
+
+	if(ends_with(outputFilename, ".json"))
+		writeJson(out, jobs);
+	else
+		writeCsv(out, jobs);
+
+	cout << "wrote performance analysis to " << outputFilename << endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,20 @@
+/*
+ * performance_analysis_tool.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef PERFORMANCE_ANALYSIS_TOOL_HPP_
+#define PERFORMANCE_ANALYSIS_TOOL_HPP_
+#include <ciso646>
+
+#include <string>
+
+/** Offline (headless) vehicle performance analysis. Loads every vehicle spec from the vehicles and traffic folders, measures each
+ *  one with every simulation type (see PerformanceAnalysis) and writes the results to the given file; as JSON if its extension is
+ *  ".json", otherwise as CSV. The vehicles are analyzed in parallel, with the given number of threads (0 means one per core).
+ *  Returns the program's exit status. */
+int runPerformanceAnalysisTool(const std::string& outputFilename, unsigned threadCount=0);
+
+#endif /* PERFORMANCE_ANALYSIS_TOOL_HPP_ */
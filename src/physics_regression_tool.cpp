@@ -0,0 +1,506 @@
+/*
+ * physics_regression_tool.cpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#include "automotive/strict_floating_point.hpp"  // must come first
+
+#include "physics_regression_tool.hpp"
+
+#include "carse_logic.hpp"
+#include "course.hpp"
+#include "vehicle.hpp"
+#include "pseudo3d_race_state.hpp"
+#include "tool_util.hpp"
+
+#include "fgeal/filesystem.hpp"
+#include "futil/string_actions.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <stdexcept>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+
+#include <sys/stat.h>
+#ifdef _WIN32
+	#include <direct.h>
+#endif
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+using futil::ends_with;
+
+static const string GOLDEN_TRACES_FOLDER = "data/physics_traces";
+
+static const unsigned TRACE_SAMPLING_INTERVAL = 100;  // in steps
+
+// a traced value matches its golden counterpart if they differ by no more than (absolute tolerance + relative tolerance * golden value)
+static const float TRACE_RELATIVE_TOLERANCE = 1e-3,
+				   TRACE_ABSOLUTE_TOLERANCE_POSITION = 0.05,  // in meters
+				   TRACE_ABSOLUTE_TOLERANCE_SPEED = 0.01,  // in m/s
+				   TRACE_ABSOLUTE_TOLERANCE_RPM = 1.0,
+				   TRACE_ABSOLUTE_TOLERANCE_SLIP_RATIO = 1e-3;
+
+static const unsigned MAXIMUM_REPORTED_MISMATCHES = 3;  // per trace file
+
+// torque curve lookups are compared over the whole RPM range with this resolution, besides at (and right next to) each section boundary
+static const float TORQUE_CURVE_CHECK_RPM_STEP = 0.25;
+
+// how many torque curve lookups are timed, per method and vehicle, and over how many distinct RPMs (precomputed, so that only lookups are timed)
+static const unsigned TORQUE_CURVE_BENCHMARK_LOOKUP_COUNT = 2000000, TORQUE_CURVE_BENCHMARK_RPM_COUNT = 4096;
+
+static volatile float benchmarkSink;  // results of benchmarked computations go here, so that they are not optimized away
+
+static const char* const INTEGRATION_METHOD_NAMES[Mechanics::INTEGRATION_METHOD_COUNT] = { "euler", "semi_implicit_euler", "rk2", "rk4" };
+
+// integration methods are benchmarked against this (tiny step) reference, and are expected to be as accurate as the baseline
+static const Mechanics::IntegrationMethod INTEGRATION_REFERENCE_METHOD = Mechanics::INTEGRATION_METHOD_RK4, INTEGRATION_BASELINE_METHOD = Mechanics::INTEGRATION_METHOD_EULER;
+static const float INTEGRATION_REFERENCE_TIME_STEP = 0.0001, INTEGRATION_BASELINE_TIME_STEP = 0.01;
+
+// the speed error (against the reference) of a method at its maximum time step may be no larger than (absolute tolerance + factor * the baseline's error)
+static const float INTEGRATION_ERROR_TOLERANCE_FACTOR = 2, INTEGRATION_ERROR_ABSOLUTE_TOLERANCE = 0.05;  // in m/s
+
+// how often speed is compared with the reference during the integration benchmark; a multiple of every benchmarked time step
+static const float INTEGRATION_BENCHMARK_SAMPLING_PERIOD = 1.2;  // in seconds
+
+namespace  // anonymous
+{
+	// a stage of an input script, during which the inputs are held constant; a stage with zero duration marks the end of the script
+	struct InputScriptStage
+	{
+		float duration, throttlePosition, brakePedalPosition;
+	};
+
+	struct InputScript
+	{
+		const char* name;
+		const InputScriptStage* stages;
+	};
+
+	// the slope profile of a course, which is all that matters to the (longitudinal) physics
+	struct CourseProfile
+	{
+		string name;
+		float segmentLength;
+		vector<float> slopeAngle, slopeAngleSine;
+	};
+
+	struct TraceSample
+	{
+		float time, position, speed, rpm, slipRatio;
+		int gear;
+	};
+}
+
+static const InputScriptStage
+	LAUNCH_AND_BRAKE_SCRIPT[] = { {25, 1, 0}, {8, 0, 1}, {0, 0, 0} },
+	THROTTLE_PULSES_SCRIPT[] = { {4, 1, 0}, {2, 0, 0}, {4, 1, 0}, {2, 0, 0.3}, {6, 0.5, 0}, {3, 0, 0}, {0, 0, 0} },
+	CRUISE_AND_COAST_SCRIPT[] = { {10, 1, 0}, {10, 0.3, 0}, {8, 0, 0}, {0, 0, 0} },
+	INTEGRATION_BENCHMARK_SCRIPT_STAGES[] = { {24, 1, 0}, {6, 0, 0}, {6, 0, 0.3}, {0, 0, 0} };  // durations must be multiples of the sampling period
+
+static const InputScript INPUT_SCRIPTS[] = {
+	{ "launch_and_brake", LAUNCH_AND_BRAKE_SCRIPT },
+	{ "throttle_pulses", THROTTLE_PULSES_SCRIPT },
+	{ "cruise_and_coast", CRUISE_AND_COAST_SCRIPT },
+};
+
+static const unsigned INPUT_SCRIPT_COUNT = sizeof(INPUT_SCRIPTS)/sizeof(*INPUT_SCRIPTS);
+
+static const InputScript INTEGRATION_BENCHMARK_SCRIPT = { "integration_benchmark", INTEGRATION_BENCHMARK_SCRIPT_STAGES };
+
+// returns the given filename without its extension and, if it starts with the given folder, without it as well
+static string getRelativeNameWithoutExtension(const string& filename, const string& folder)
+{
+	string name = filename.substr(0, filename.find_last_of("."));
+	if(name.compare(0, folder.size()+1, folder + "/") == 0)
+		name = name.substr(folder.size()+1);
+	return name;
+}
+
+static vector<CourseProfile> loadCourseProfiles()
+{
+	vector<CourseProfile> profiles;
+	const vector<string> filenames = fgeal::filesystem::getFilenamesWithinDirectory(CarseLogic::COURSES_FOLDER);
+	for(unsigned i = 0; i < filenames.size(); i++)
+	{
+		if(not ends_with(filenames[i], ".properties"))
+			continue;
+
+		Pseudo3DCourse::Spec spec(0, 0);
+		try { spec.loadFromFile(filenames[i]); }
+		catch(const std::exception& e) { cout << "skipping course " << filenames[i] << ": " << e.what() << endl; continue; }
+
+		if(spec.lines.empty())
+			continue;
+
+		CourseProfile profile;
+		profile.name = getRelativeNameWithoutExtension(filenames[i], CarseLogic::COURSES_FOLDER);
+		profile.segmentLength = spec.roadSegmentLength;
+
+		// same as done by Pseudo3DRaceState when loading a course
+		for(unsigned s = 0; s < spec.lines.size(); s++)
+		{
+			profile.slopeAngle.push_back(spec.getSlopeAngle(s));
+			profile.slopeAngleSine.push_back(spec.getSlopeAngleSine(s));
+		}
+		profiles.push_back(profile);
+	}
+	return profiles;
+}
+
+// drives (a copy of) the given body through the given script, on the given course, with the given integration method and time step, recording
+// a trace sample every given number of steps; returns the number of steps taken
+static unsigned simulateRun(const Mechanics& body, Mechanics::IntegrationMethod integrationMethod, float timeStep, unsigned samplingInterval,
+							const CourseProfile& course, const InputScript& script, vector<TraceSample>& samples)
+{
+	const float courseLength = course.slopeAngle.size() * course.segmentLength / Pseudo3DRaceState::DEFAULT_COURSE_POSITION_FACTOR;
+
+	Mechanics vehicle(body);
+	vehicle.reset();
+	vehicle.integrationMethod = integrationMethod;
+	vehicle.automaticShiftingEnabled = true;
+	vehicle.automaticShiftingLastTime = 0;
+	vehicle.shiftGear(1);
+
+	float position = 0;
+	unsigned stepCount = 0;
+	for(const InputScriptStage* stage = script.stages; stage->duration > 0; stage++)
+	{
+		const unsigned stageStepCount = stage->duration / timeStep + 0.5f;
+		for(unsigned i = 0; i < stageStepCount; i++)
+		{
+			const unsigned segmentIndex = static_cast<unsigned>(position * Pseudo3DRaceState::DEFAULT_COURSE_POSITION_FACTOR / course.segmentLength) % course.slopeAngle.size();
+			vehicle.setSlopeAngle(course.slopeAngle[segmentIndex], course.slopeAngleSine[segmentIndex]);
+			vehicle.engine.throttlePosition = stage->throttlePosition;
+			vehicle.brakePedalPosition = stage->brakePedalPosition;
+			vehicle.updatePowertrain(timeStep);
+
+			position += vehicle.speed * timeStep;
+			while(position >= courseLength) position -= courseLength;
+			while(position < 0) position += courseLength;
+
+			if(++stepCount % samplingInterval == 0)
+			{
+				const TraceSample sample = { stepCount * timeStep, position, vehicle.speed, vehicle.engine.rpm, static_cast<float>(vehicle.slipRatio), vehicle.engine.gear };
+				samples.push_back(sample);
+			}
+		}
+	}
+	return stepCount;
+}
+
+// drives (a copy of) the given body through the integration benchmark script, on flat ground, with the given integration method and time step;
+// stores its speed at every sampling period and returns the time spent (in seconds)
+static double simulateIntegrationBenchmarkRun(const Mechanics& body, Mechanics::IntegrationMethod integrationMethod, float timeStep, vector<TraceSample>& samples)
+{
+	CourseProfile flatCourse;
+	flatCourse.segmentLength = 1;
+	flatCourse.slopeAngle.push_back(0);
+	flatCourse.slopeAngleSine.push_back(0);
+
+	const clock_t startTime = clock();
+	simulateRun(body, integrationMethod, timeStep, INTEGRATION_BENCHMARK_SAMPLING_PERIOD / timeStep + 0.5f, flatCourse, INTEGRATION_BENCHMARK_SCRIPT, samples);
+	return static_cast<double>(clock() - startTime) / CLOCKS_PER_SEC;
+}
+
+// returns the largest speed difference between the given samples and the reference ones
+static float getMaximumSpeedError(const vector<TraceSample>& samples, const vector<TraceSample>& referenceSamples)
+{
+	float maximumError = 0;
+	for(unsigned i = 0; i < samples.size() and i < referenceSamples.size(); i++)
+		if(fabs(samples[i].speed - referenceSamples[i].speed) > maximumError)
+			maximumError = fabs(samples[i].speed - referenceSamples[i].speed);
+	return maximumError;
+}
+
+// benchmarks each integration method, at its maximum time step (see Mechanics::getMaximumTimeStep()), against a tiny-step reference, reporting
+// its speed error and cost; returns the number of methods whose error exceeds the baseline's (explicit euler at 0.01s) beyond tolerance
+static unsigned benchmarkIntegrationMethods(const Mechanics& body)
+{
+	unsigned failedCount = 0;
+	Mechanics vehicle(body);
+	for(unsigned type = 0; type < Mechanics::SIMULATION_TYPE_COUNT; type++)
+	{
+		vehicle.simulationType = static_cast<Mechanics::SimulationType>(type);
+		vector<TraceSample> referenceSamples, baselineSamples;
+		simulateIntegrationBenchmarkRun(vehicle, INTEGRATION_REFERENCE_METHOD, INTEGRATION_REFERENCE_TIME_STEP, referenceSamples);
+		simulateIntegrationBenchmarkRun(vehicle, INTEGRATION_BASELINE_METHOD, INTEGRATION_BASELINE_TIME_STEP, baselineSamples);
+		const float baselineError = getMaximumSpeedError(baselineSamples, referenceSamples);
+
+		std::ostringstream report;
+		report << "  " << SIMULATION_TYPE_NAMES[type] << " integration (max. speed error, cost per simulated second):";
+		for(unsigned method = 0; method < Mechanics::INTEGRATION_METHOD_COUNT; method++)
+		{
+			const Mechanics::IntegrationMethod integrationMethod = static_cast<Mechanics::IntegrationMethod>(method);
+			const float timeStep = Mechanics::getMaximumTimeStep(vehicle.simulationType, integrationMethod);
+
+			vector<TraceSample> samples;
+			const double elapsedTime = simulateIntegrationBenchmarkRun(vehicle, integrationMethod, timeStep, samples);
+			const float error = getMaximumSpeedError(samples, referenceSamples);
+			const bool accurate = samples.size() == referenceSamples.size()
+								  and error <= INTEGRATION_ERROR_ABSOLUTE_TOLERANCE + INTEGRATION_ERROR_TOLERANCE_FACTOR * baselineError;
+
+			report << " " << INTEGRATION_METHOD_NAMES[method] << "@" << timeStep << "s " << error << "m/s "
+				   << 1e6 * elapsedTime / samples.back().time << "us" << (accurate? "" : " (TOO INACCURATE)") << (method + 1 < Mechanics::INTEGRATION_METHOD_COUNT? "," : "");
+			if(not accurate)
+				failedCount++;
+		}
+		cout << report.str() << endl;
+	}
+	return failedCount;
+}
+
+// compares the table-based torque curve lookup against the linear scan over the engine's RPM range (up to a bit past the redline); returns
+// the number of mismatching lookups (reporting the first ones). both should be bit-identical, since they evaluate the same line section
+static unsigned checkTorqueCurveLookups(const Engine& engine)
+{
+	const Engine::TorqueCurveProfile& profile = engine.torqueCurveProfile;
+	vector<float> rpms;
+	for(float rpm = 0; rpm <= 1.1f * engine.maxRpm; rpm += TORQUE_CURVE_CHECK_RPM_STEP)
+		rpms.push_back(rpm);
+
+	for(unsigned i = 0; i < profile.sections.size(); i++)
+	{
+		rpms.push_back(profile.sections[i].rpm);
+		rpms.push_back(nextafterf(profile.sections[i].rpm, 0));
+		rpms.push_back(nextafterf(profile.sections[i].rpm, 2 * profile.sections[i].rpm));
+	}
+
+	unsigned mismatchCount = 0;
+	for(unsigned i = 0; i < rpms.size(); i++)
+	{
+		const float factor = profile.getTorqueFactor(rpms[i]), referenceFactor = profile.getTorqueFactorByLinearScan(rpms[i]);
+		if(factor != referenceFactor)
+		{
+			if(mismatchCount < MAXIMUM_REPORTED_MISMATCHES)
+			{
+				char buffer[128];
+				sprintf(buffer, "  torque factor at %.9g rpm: expected %.9g, got %.9g", rpms[i], referenceFactor, factor);
+				cout << buffer << endl;
+			}
+			mismatchCount++;
+		}
+	}
+	return mismatchCount;
+}
+
+// times torque curve lookups over the engine's operating range, with the lookup table or by linear scan; returns the time per lookup, in nanoseconds
+static double benchmarkTorqueCurveLookups(const Engine& engine, bool linearScan)
+{
+	const Engine::TorqueCurveProfile& profile = engine.torqueCurveProfile;
+	vector<float> rpms(TORQUE_CURVE_BENCHMARK_RPM_COUNT);
+	for(unsigned i = 0; i < rpms.size(); i++)  // scattered, so that consecutive lookups don't hit the same section
+		rpms[i] = engine.minRpm + (engine.maxRpm - engine.minRpm) * ((i * 2654435761u) % TORQUE_CURVE_BENCHMARK_RPM_COUNT) / TORQUE_CURVE_BENCHMARK_RPM_COUNT;
+
+	float sum = 0;
+	const clock_t startTime = clock();
+	for(unsigned i = 0; i < TORQUE_CURVE_BENCHMARK_LOOKUP_COUNT; i++)
+	{
+		const float rpm = rpms[i % TORQUE_CURVE_BENCHMARK_RPM_COUNT];
+		sum += linearScan? profile.getTorqueFactorByLinearScan(rpm) : profile.getTorqueFactor(rpm);
+	}
+	const double elapsedTime = static_cast<double>(clock() - startTime) / CLOCKS_PER_SEC;
+	benchmarkSink = sum;
+	return 1e9 * elapsedTime / TORQUE_CURVE_BENCHMARK_LOOKUP_COUNT;
+}
+
+static string formatTraceLine(const string& runKey, const TraceSample& sample)
+{
+	char buffer[256];
+	sprintf(buffer, "%s %.2f %.7g %.7g %.7g %d %.7g", runKey.c_str(), sample.time, sample.position, sample.speed, sample.rpm, sample.gear, sample.slipRatio);
+	return buffer;
+}
+
+static bool isWithinTolerance(float value, float golden, float absoluteTolerance)
+{
+	return fabs(value - golden) <= absoluteTolerance + TRACE_RELATIVE_TOLERANCE * fabs(golden);
+}
+
+// returns true if the given trace lines match
+static bool isTraceLineMatching(const string& line, const string& goldenLine)
+{
+	std::istringstream lineStream(line), goldenLineStream(goldenLine);
+	string course, type, script, goldenCourse, goldenType, goldenScript;
+	TraceSample sample, goldenSample;
+
+	lineStream >> course >> type >> script >> sample.time >> sample.position >> sample.speed >> sample.rpm >> sample.gear >> sample.slipRatio;
+	goldenLineStream >> goldenCourse >> goldenType >> goldenScript >> goldenSample.time >> goldenSample.position >> goldenSample.speed >> goldenSample.rpm >> goldenSample.gear >> goldenSample.slipRatio;
+
+	return not goldenLineStream.fail()
+		and course == goldenCourse and type == goldenType and script == goldenScript
+		and fabs(sample.time - goldenSample.time) < 0.005
+		and sample.gear == goldenSample.gear
+		and isWithinTolerance(sample.position, goldenSample.position, TRACE_ABSOLUTE_TOLERANCE_POSITION)
+		and isWithinTolerance(sample.speed, goldenSample.speed, TRACE_ABSOLUTE_TOLERANCE_SPEED)
+		and isWithinTolerance(sample.rpm, goldenSample.rpm, TRACE_ABSOLUTE_TOLERANCE_RPM)
+		and isWithinTolerance(sample.slipRatio, goldenSample.slipRatio, TRACE_ABSOLUTE_TOLERANCE_SLIP_RATIO);
+}
+
+// compares the given trace with the golden one, stored in the given file; returns the number of mismatching lines (or -1 if there is no golden trace)
+static int compareWithGoldenTrace(const vector<string>& traceLines, const string& goldenFilename)
+{
+	std::ifstream goldenFile(goldenFilename.c_str());
+	if(not goldenFile)
+		return -1;
+
+	vector<string> goldenLines;
+	string line;
+	while(std::getline(goldenFile, line))
+		if(not line.empty() and line[0] != '#')
+			goldenLines.push_back(line);
+
+	int mismatchCount = 0;
+	for(unsigned i = 0; i < traceLines.size() or i < goldenLines.size(); i++)
+	{
+		const string& traceLine = i < traceLines.size()? traceLines[i] : string(),
+					& goldenLine = i < goldenLines.size()? goldenLines[i] : string();
+
+		if(not isTraceLineMatching(traceLine, goldenLine))
+		{
+			if(mismatchCount < (int) MAXIMUM_REPORTED_MISMATCHES)
+				cout << "  expected: " << (goldenLine.empty()? "<nothing>" : goldenLine) << endl
+					 << "  got:      " << (traceLine.empty()? "<nothing>" : traceLine) << endl;
+			mismatchCount++;
+		}
+	}
+	return mismatchCount;
+}
+
+int runPhysicsRegressionTool(bool record)
+{
+	CarseLogic::getInstance().loadPresets();  // vehicle specs may refer to preset engine sound profiles
+
+	const vector<CourseProfile> courses = loadCourseProfiles();
+	if(courses.empty())
+	{
+		cout << "error: no courses to drive on" << endl;
+		return EXIT_FAILURE;
+	}
+
+	vector<string> vehicleFilenames = CarseLogic::getPropertiesFilenamesWithinDirectory(CarseLogic::VEHICLES_FOLDER);
+	const vector<string> trafficVehicleFilenames = CarseLogic::getPropertiesFilenamesWithinDirectory(CarseLogic::TRAFFIC_FOLDER);
+	vehicleFilenames.insert(vehicleFilenames.end(), trafficVehicleFilenames.begin(), trafficVehicleFilenames.end());
+
+	if(record)
+	{
+		#ifdef _WIN32
+			_mkdir(GOLDEN_TRACES_FOLDER.c_str());
+		#else
+			mkdir(GOLDEN_TRACES_FOLDER.c_str(), 0755);
+		#endif
+	}
+
+	bool failed = false;
+	double totalTime = 0;
+	unsigned long totalStepCount = 0;
+	for(unsigned v = 0; v < vehicleFilenames.size(); v++)
+	{
+		const string& filename = vehicleFilenames[v];
+		Pseudo3DVehicle::Spec spec;
+		try { spec.loadFromFile(filename); }
+		catch(const std::exception& e) { cout << "skipping vehicle " << filename << ": " << e.what() << endl; continue; }
+
+		Pseudo3DVehicle vehicle;
+		vehicle.setSpec(spec);
+
+		// trace name is the spec's path (relative to the data folder), with slashes replaced
+		string traceName = getRelativeNameWithoutExtension(filename, "data");
+		for(unsigned i = 0; i < traceName.size(); i++)
+			if(traceName[i] == '/' or traceName[i] == '\\')
+				traceName[i] = '_';
+
+		// simulate all runs first, so that timing is not affected by formatting
+		vector< vector<TraceSample> > runSamples;
+		vector<string> runKeys;
+		unsigned long stepCount = 0;
+		const clock_t startTime = clock();
+		for(unsigned c = 0; c < courses.size(); c++)
+			for(unsigned type = 0; type < Mechanics::SIMULATION_TYPE_COUNT; type++)
+				for(unsigned s = 0; s < INPUT_SCRIPT_COUNT; s++)
+				{
+					vehicle.body.simulationType = static_cast<Mechanics::SimulationType>(type);
+					runSamples.push_back(vector<TraceSample>());
+					runKeys.push_back(courses[c].name + " " + SIMULATION_TYPE_NAMES[type] + " " + INPUT_SCRIPTS[s].name);
+					stepCount += simulateRun(vehicle.body, Mechanics::getDefaultIntegrationMethod(vehicle.body.simulationType), Pseudo3DRaceState::DETERMINISTIC_PHYSICS_TIME_STEP,
+											 TRACE_SAMPLING_INTERVAL, courses[c], INPUT_SCRIPTS[s], runSamples.back());
+				}
+		const double elapsedTime = static_cast<double>(clock() - startTime) / CLOCKS_PER_SEC;
+		totalTime += elapsedTime;
+		totalStepCount += stepCount;
+
+		vector<string> traceLines;
+		for(unsigned r = 0; r < runSamples.size(); r++)
+			for(unsigned i = 0; i < runSamples[r].size(); i++)
+				traceLines.push_back(formatTraceLine(runKeys[r], runSamples[r][i]));
+
+		cout << traceName << ": " << stepCount << " steps, " << (stepCount > 0? 1e9 * elapsedTime / stepCount : 0) << " ns/step"
+			 << "; torque curve lookup: " << benchmarkTorqueCurveLookups(vehicle.body.engine, false) << " ns (linear scan: "
+			 << benchmarkTorqueCurveLookups(vehicle.body.engine, true) << " ns)";
+
+
+		const string goldenFilename = GOLDEN_TRACES_FOLDER + "/" + traceName + ".trace";
+		if(record)
+		{
+			std::ofstream goldenFile(goldenFilename.c_str());
+			goldenFile << "# golden physics trace of " << filename << endl
+					   << "# course simulation_type script time(s) position(m) speed(m/s) rpm gear slip_ratio" << endl;
+			for(unsigned i = 0; i < traceLines.size(); i++)
+				goldenFile << traceLines[i] << '\n';
+
+			if(goldenFile)
+				cout << ", recorded " << goldenFilename << endl;
+			else
+			{
+				cout << ", error: could not write " << goldenFilename << endl;
+				failed = true;
+			}
+		}
+		else
+		{
+			cout << endl;
+			const int mismatchCount = compareWithGoldenTrace(traceLines, goldenFilename);
+			if(mismatchCount < 0)
+			{
+				cout << "  FAILED: no golden trace (" << goldenFilename << ")" << endl;
+				failed = true;
+			}
+			else if(mismatchCount > 0)
+			{
+				cout << "  FAILED: " << mismatchCount << " of " << traceLines.size() << " samples differ from the golden trace" << endl;
+				failed = true;
+			}
+		}
+
+		const unsigned torqueCurveMismatchCount = checkTorqueCurveLookups(vehicle.body.engine);
+		if(torqueCurveMismatchCount > 0)
+		{
+			cout << "  FAILED: " << torqueCurveMismatchCount << " torque curve lookups differ from the linear scan" << endl;
+			failed = true;
+		}
+
+		const unsigned inaccurateIntegrationCount = benchmarkIntegrationMethods(vehicle.body);
+		if(inaccurateIntegrationCount > 0)
+		{
+			cout << "  FAILED: " << inaccurateIntegrationCount << " integration methods are less accurate than the baseline at their maximum time step" << endl;
+			failed = true;
+		}
+	}
+
+	cout << "overall: " << totalStepCount << " steps, " << (totalStepCount > 0? 1e9 * totalTime / totalStepCount : 0) << " ns/step" << endl;
+
+	if(not record)
+		cout << (failed? "physics regression check FAILED" : "physics regression check passed") << endl;
+
+	return failed? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,24 @@
+/*
+ * physics_regression_tool.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef PHYSICS_REGRESSION_TOOL_HPP_
+#define PHYSICS_REGRESSION_TOOL_HPP_
+#include <ciso646>
+
+/** Offline (headless) physics regression check and benchmark. Drives every vehicle (from the vehicles and traffic folders) through a
+ *  set of fixed input scripts, on the slope profile of every course and with every simulation type, recording a trace of each run
+ *  (position, speed, rpm, gear and slip ratio, sampled periodically). If 'record' is true, the traces are saved as golden traces
+ *  (one file per vehicle, in the data/physics_traces folder); otherwise, they are compared against the saved golden traces, within
+ *  tolerances, and any mismatch is reported. In both cases, the time spent per physics step (in nanoseconds) is reported for each
+ *  vehicle, and its engine's torque curve lookups (see Engine::TorqueCurveProfile::getTorqueFactor()) are checked against the linear
+ *  scan over its whole RPM range, and timed against it. Each integration method is also benchmarked, with every simulation type, at
+ *  its maximum time step (see Mechanics::getMaximumTimeStep()) against a tiny-step reference, and must be about as accurate as the
+ *  baseline (explicit euler at 0.01s). Returns the program's exit status (failure if any trace mismatched or was missing, if any
+ *  torque curve lookup mismatched or if any integration method was too inaccurate). */
+int runPhysicsRegressionTool(bool record);
+
+#endif /* PHYSICS_REGRESSION_TOOL_HPP_ */
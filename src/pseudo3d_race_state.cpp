@@ -5,13 +5,19 @@
  *      Author: carlosfaruolo
  */
 
+#include "automotive/strict_floating_point.hpp"  // must come first
+
 #include "pseudo3d_race_state.hpp"
 
 #include "carse_game.hpp"
 
 #include "util.hpp"
 
-#include "futil/random.h"
+#include "audio/audio_loader.hpp"
+#include "audio/sound_cache.hpp"
+
+#include "gfx/image_cache.hpp"
+
 #include "futil/snprintf.h"
 
 #include <algorithm>
@@ -46,13 +52,117 @@ using fgeal::Rectangle;
 
 const float Pseudo3DRaceState::MAXIMUM_STRAFE_SPEED_FACTOR = 30;  // undefined unit
 
+const float Pseudo3DRaceState::DETERMINISTIC_PHYSICS_TIME_STEP = 0.01;  // must not be larger than any maximum time step given by Mechanics::getMaximumTimeStep()
+const float Pseudo3DRaceState::DEFAULT_COURSE_POSITION_FACTOR = 500;
+
 static const float MINIMUM_SPEED_TO_SIDESLIP = 5.5556,  // == 20kph
 		GLOBAL_VEHICLE_SCALE_FACTOR = 0.0048828125,
 		HORIZON_DISTANCE = 7.14,  // == 7.14km TODO use camera height instead in the horizon formula: 3.57*sqrt(cameraHeightInMeters)
 		BACKGROUND_HORIZONTAL_PARALLAX_FACTOR = 0.35 * HORIZON_DISTANCE,
 		BACKGROUND_VERTICAL_PARALLAX_FACTOR = 0.509375,
 		MPS_TO_MPH = 2.236936,  // m/s to mph conversion factor
-		MPS_TO_KPH = 3.6;  // m/s to km/h conversion factor
+		MPS_TO_KPH = 3.6,  // m/s to km/h conversion factor
+		OPPONENT_GRID_ROW_SPACING = 8,  // the distance between rows of the starting grid, in meters
+		OPPONENT_GRID_LATERAL_OFFSET_FACTOR = 0.4;  // the lateral position of each grid column, as a fraction of the road width
+
+// how many traffic and opponent vehicles can have their engine sound heard at the same time
+static const unsigned VEHICLE_VOICE_COUNT = 4;
+
+// how much time (in seconds) is spent loading assets on each frame, while the loading screen is shown
+static const float LOADING_TIME_SLICE = 0.010;
+
+// in the same order as the sound effect fields are acquired in finishLoading()
+static const unsigned SOUND_EFFECT_COUNT = 9;
+static const char* const SOUND_EFFECT_FILENAMES[SOUND_EFFECT_COUNT] = {
+	"assets/sound/tire_burnout_stand1_intro.ogg", "assets/sound/tire_burnout_stand1_loop.ogg",
+	"assets/sound/tire_burnout_normal1_intro.ogg", "assets/sound/tire_burnout_normal1_loop.ogg",
+	"assets/sound/on_gravel.ogg", "assets/sound/crash.ogg", "assets/sound/landing.ogg",
+	"assets/sound/countdown-buzzer.ogg", "assets/sound/countdown-buzzer-final.ogg"
+};
+
+namespace  // anonymous
+{
+	// a minimal pseudo-random number generator (LCG), used instead of rand() since it yields the same sequence on every platform for a given seed
+	struct SeededRandom
+	{
+		unsigned long state;
+
+		SeededRandom(unsigned long seed) : state(seed & 0xFFFFFFFFUL) {}
+
+		// returns a random integer in the range [min, max)
+		int between(int min, int max)
+		{
+			state = (1664525UL * state + 1013904223UL) & 0xFFFFFFFFUL;
+			return min + static_cast<int>((state >> 8) % static_cast<unsigned long>(max - min));
+		}
+
+		// returns a random decimal in the range [min, max)
+		float betweenDecimal(float min, float max)
+		{
+			return min + (max - min) * (between(0, 1 << 24) / 16777216.0f);
+		}
+	};
+
+	// orders vehicles by the atlas page they're drawn from (vehicles not drawn from the atlas come last)
+	struct AtlasPageComparator
+	{
+		const TextureAtlas& atlas;
+
+		AtlasPageComparator(const TextureAtlas& atlas) : atlas(atlas) {}
+
+		bool operator()(const Pseudo3DVehicle* vehicle1, const Pseudo3DVehicle* vehicle2) const
+		{
+			return getPageIndex(vehicle1) < getPageIndex(vehicle2);
+		}
+
+		unsigned getPageIndex(const Pseudo3DVehicle* vehicle) const
+		{
+			return vehicle->sprites.empty()? atlas.getPageCount() : atlas.getPageIndex(vehicle->sprites[0]->image);
+		}
+	};
+
+	struct VehicleGraphicsLoadingJob extends AssetLoadingQueue::Job
+	{
+		Pseudo3DVehicle& vehicle;
+
+		VehicleGraphicsLoadingJob(Pseudo3DVehicle& vehicle) : vehicle(vehicle) {}
+
+		void run()
+		{
+			vehicle.loadGraphicAssetsData();
+		}
+	};
+
+	// renders a vehicle's synthesized engine sounds ahead of time, so that voices don't render them mid-race (see EngineVoiceManager)
+	struct EngineSoundRenderingJob extends AssetLoadingQueue::Job
+	{
+		const EngineSoundSimulator& engineSound;
+
+		EngineSoundRenderingJob(const EngineSoundSimulator& engineSound) : engineSound(engineSound) {}
+
+		void run()
+		{
+			engineSound.renderSynthesizedSounds();  // on failure, the vehicle's spec just gets no voice profile (see finishLoading())
+		}
+	};
+}
+
+static void queueSounds(AssetLoadingQueue& queue, const vector<string>& filenames, unsigned instance)
+{
+	for(unsigned i = 0; i < filenames.size(); i++)
+		queue.addSound(filenames[i], instance);
+}
+
+// an empirical measure of how well a vehicle holds on curves, which decreases with its weight
+static float computeCorneringStiffness(const Mechanics& body)
+{
+	return 0.575 + 0.575/(1+exp(-0.4*(10.0 - (body.mass*GRAVITY_ACCELERATION)/1000.0)));
+}
+
+float Pseudo3DRaceState::getMaximumStrafeSpeed(const Mechanics& body)
+{
+	return MAXIMUM_STRAFE_SPEED_FACTOR * computeCorneringStiffness(body);
+}
 
 // -------------------------------------------------------------------------------
 
@@ -68,15 +178,21 @@ Pseudo3DRaceState::Pseudo3DRaceState(CarseGame* game)
   sndRunningOnDirtLoop(null),
   sndCrashImpact(null), sndJumpImpact(null),
   sndCountdownBuzzer(null), sndCountdownBuzzerFinal(null),
+  sndOtherVehiclesCrashImpact(null),
+  playerSoundEffects(), otherVehiclesSoundEffects(),
 
   bgColor(), bgColorHorizon(),
   spriteSmoke(null), spriteBackground(null), verticalBackgroundParallax(),
 
-  coursePositionFactor(500), playerVehicleProjectionOffset(6), courseStartPositionOffset(0), simulationType(), enableJumpSimulation(),
+  coursePositionFactor(DEFAULT_COURSE_POSITION_FACTOR), playerVehicleProjectionOffset(6), courseStartPositionOffset(0), simulationType(), enableJumpSimulation(),
   onSceneIntro(), onSceneFinish(), timerSceneIntro(), timerSceneFinish(), countdownBuzzerCounter(), settings(),
-  lapTimeCurrent(0), lapTimeBest(0), lapCurrent(0), acc0to60clock(0), acc0to60time(0),
+  lapTimeCurrent(0), lapTimeBest(0), lapCurrent(0),
+  simulationTime(0), physicsTimeAccumulator(0), physicsStepCount(0), physicsStateHash(0),
+  acc0to60clock(0), acc0to60time(0),
 
   course(), playerVehicle(),
+  vehicleVoices(), vehicleVoiceProfileIndexes(), vehicleSoundSources(),
+  vehicleAssetsBindings(), vehicleAtlas(), assetLoadingQueue(), loading(false),
 
   hudDialTachometer(playerVehicle.body.engine.rpm),
   hudDialSpeedometer(playerVehicle.body.speed),
@@ -102,6 +218,8 @@ Pseudo3DRaceState::Pseudo3DRaceState(CarseGame* game)
   controlJoystickKeyShiftDown(4),
   controlJoystickAxisTurn(0),
 
+  playerSurfaceType(SURFACE_TYPE_DRY_ASPHALT), segmentPhysics(),
+
   debugMode(true)
 {}
 
@@ -112,21 +230,35 @@ Pseudo3DRaceState::~Pseudo3DRaceState()
 	if(fontCountdown != null) delete fontCountdown;
 	if(fontTimers != null) delete fontTimers;
 
-	if(spriteBackground != null) delete spriteBackground;
-	if(imgStopwatch != null) delete imgStopwatch;
+	if(spriteBackground != null)
+	{
+		ImageCache::release(spriteBackground->image);
+		delete spriteBackground;
+	}
+	ImageCache::release(imgStopwatch);
 	if(music != null) delete music;
 
-	if(sndWheelspinBurnoutIntro != null) delete sndWheelspinBurnoutIntro;
-	if(sndWheelspinBurnoutLoop != null) delete sndWheelspinBurnoutLoop;
-	if(sndSideslipBurnoutIntro != null) delete sndSideslipBurnoutIntro;
-	if(sndSideslipBurnoutLoop != null) delete sndSideslipBurnoutLoop;
-	if(sndRunningOnDirtLoop != null) delete sndRunningOnDirtLoop;
-	if(sndCrashImpact != null) delete sndCrashImpact;
-	if(sndJumpImpact != null) delete sndJumpImpact;
-	if(sndCountdownBuzzer != null) delete sndCountdownBuzzer;
-	if(sndCountdownBuzzerFinal != null) delete sndCountdownBuzzerFinal;
-
-	if(spriteSmoke != null) delete spriteSmoke;
+	// cached images, which must not be deleted by the gauges themselves
+	ImageCache::release(hudDialTachometer.pointerImage);
+	ImageCache::release(hudDialSpeedometer.pointerImage);
+	hudDialTachometer.pointerImage = hudDialSpeedometer.pointerImage = null;
+
+	SoundCache::release(sndWheelspinBurnoutIntro);
+	SoundCache::release(sndWheelspinBurnoutLoop);
+	SoundCache::release(sndSideslipBurnoutIntro);
+	SoundCache::release(sndSideslipBurnoutLoop);
+	SoundCache::release(sndRunningOnDirtLoop);
+	SoundCache::release(sndCrashImpact);
+	SoundCache::release(sndJumpImpact);
+	SoundCache::release(sndCountdownBuzzer);
+	SoundCache::release(sndCountdownBuzzerFinal);
+	SoundCache::release(sndOtherVehiclesCrashImpact);
+
+	if(spriteSmoke != null)
+	{
+		ImageCache::release(spriteSmoke->image);
+		delete spriteSmoke;
+	}
 	playerVehicle.smokeSprite = null;
 }
 
@@ -137,19 +269,9 @@ void Pseudo3DRaceState::initialize()
 	fontCountdown = new Font(game.sharedResources->font2Path);
 	fontTimers = new Font(game.sharedResources->font1Path);
 
-	imgStopwatch = new Image("assets/stopwatch.png");
+	imgStopwatch = ImageCache::acquire("assets/stopwatch.png");
 
-	sndWheelspinBurnoutIntro = new Sound("assets/sound/tire_burnout_stand1_intro.ogg", game.logic.masterVolume);
-	sndWheelspinBurnoutLoop = new Sound("assets/sound/tire_burnout_stand1_loop.ogg", game.logic.masterVolume);
-	sndSideslipBurnoutIntro = new Sound("assets/sound/tire_burnout_normal1_intro.ogg", game.logic.masterVolume);
-	sndSideslipBurnoutLoop = new Sound("assets/sound/tire_burnout_normal1_loop.ogg", game.logic.masterVolume);
-	sndRunningOnDirtLoop = new Sound("assets/sound/on_gravel.ogg", game.logic.masterVolume);
-	sndCrashImpact = new Sound("assets/sound/crash.ogg", game.logic.masterVolume);
-	sndJumpImpact = new Sound("assets/sound/landing.ogg", game.logic.masterVolume);
-	sndCountdownBuzzer = new Sound("assets/sound/countdown-buzzer.ogg", 0.8 * game.logic.masterVolume);
-	sndCountdownBuzzerFinal = new Sound("assets/sound/countdown-buzzer-final.ogg", 0.8 * game.logic.masterVolume);
-
-	spriteSmoke = new Sprite(new Image("assets/smoke-sprite.png"), 32, 32, 0.036, true);
+	spriteSmoke = new Sprite(ImageCache::acquire("assets/smoke-sprite.png"), 32, 32, 0.036, false);
 
 	hudDialTachometer.graduationValueScale = 0.001;
 	hudDialTachometer.graduationFont = fontSmall;
@@ -221,7 +343,11 @@ void Pseudo3DRaceState::onEnter()
 	simulationType = game.logic.getSimulationType();
 	enableJumpSimulation = game.logic.isJumpSimulationEnabled();
 
-	course.loadSpec(game.logic.getNextCourse());
+	// assets are not loaded here, but queued, and then loaded while the loading screen is shown (see updateLoading() and finishLoading())
+	assetLoadingQueue.clear();
+	loading = true;
+
+	course.setSpec(game.logic.getNextCourse());
 	course.drawAreaWidth = displayWidth;
 	course.drawAreaHeight = displayHeight;
 	course.drawDistance = 300;
@@ -229,28 +355,37 @@ void Pseudo3DRaceState::onEnter()
 	course.lengthScale = coursePositionFactor;
 	course.vehicles.clear();
 
-	minimap = Pseudo3DCourse::Map(course.spec);
-
-	if(spriteBackground != null)
-		delete spriteBackground;
-
-	Image* imgBackground = new Image(course.spec.landscapeFilename);
-	spriteBackground = new Sprite(imgBackground, imgBackground->getWidth(), imgBackground->getHeight(), 0.25, true);
-	spriteBackground->scale *= 0.2 * displayHeight / spriteBackground->height;
+	for(unsigned i = 0; i < course.spec.spritesFilenames.size(); i++)
+		if(not course.spec.spritesFilenames[i].empty())
+			assetLoadingQueue.addImage(course.spec.spritesFilenames[i]);
 
-	bgColor = course.spec.colorLandscape;
-	bgColorHorizon = course.spec.colorHorizon;
-
-	if(music != null)
-		delete music;
+	assetLoadingQueue.addImage(course.spec.landscapeFilename);
 
 	if(not course.spec.musicFilename.empty())
+		assetLoadingQueue.addMusic(course.spec.musicFilename);  // usually already prefetched by the course selection screen
+
+	if(sndWheelspinBurnoutIntro == null)  // sound effects are only loaded for the first race, and kept afterwards
 	{
-		music = new fgeal::Music(course.spec.musicFilename);
-		music->setVolume(game.logic.masterVolume);
+		for(unsigned i = 0; i < SOUND_EFFECT_COUNT; i++)
+			assetLoadingQueue.addSound(SOUND_EFFECT_FILENAMES[i]);
+		assetLoadingQueue.addSound("assets/sound/crash.ogg", 1);
 	}
-	else
-		music = null;
+
+	if(settings.hudType != HUD_TYPE_BAR_TACHO_NUMERIC_SPEEDO and not settings.hudDialGaugePointerImageFilename.empty())
+		assetLoadingQueue.addImage(settings.hudDialGaugePointerImageFilename);
+
+	minimap = Pseudo3DCourse::Map(course.spec);
+	computeSegmentPhysics();
+
+	// in deterministic physics mode, traffic and opponents placement must be the same on every run with the same seed
+	SeededRandom randomGenerator(settings.deterministicPhysics? settings.randomSeed : rand());
+
+	// each vehicle spec with engine sound gets a voice profile (shared by vehicles of the same spec), whose sounds are loaded by each voice
+	// when it first plays it; sounds released by the previous race's voices stay in the SoundCache for a while, so they're not decoded again
+	vehicleVoices.reset(VEHICLE_VOICE_COUNT);
+	vehicleVoices.volume = game.logic.masterVolume;
+	vehicleVoiceProfileIndexes.clear();
+	vehicleAssetsBindings.clear();
 
 	if(not trafficVehicles.empty())
 		trafficVehicles.clear();
@@ -269,47 +404,219 @@ void Pseudo3DRaceState::onEnter()
 
 		for(unsigned i = 0; i < trafficCount; i++)
 		{
-			const unsigned trafficVehicleIndex = futil::random_between(0, trafficVehicleSpecs.size());
+			const unsigned trafficVehicleIndex = randomGenerator.between(0, trafficVehicleSpecs.size());
 			const Pseudo3DVehicle::Spec& spec = trafficVehicleSpecs[trafficVehicleIndex];  // grab randomly chosen spec
 			vector<Pseudo3DVehicle*>& sharedVehicles = allSharedVehicles[trafficVehicleIndex];  // grab list of "base" vehicles to use their assets
-			const int skinIndex = spec.alternateSprites.empty()? -1 : futil::random_between(-1, spec.alternateSprites.size());
+			const int skinIndex = spec.alternateSprites.empty()? -1 : randomGenerator.between(-1, spec.alternateSprites.size());
 			Pseudo3DVehicle& trafficVehicle = trafficVehicles[i];
 			trafficVehicle.setSpec(spec, skinIndex);
 
-			// if first instance of this spec/skin, load assets and record a pointer
+			// if first instance of this spec/skin, it will load the assets; if repeated spec/skin, it will use assets from the first ("base") vehicle
 			if(sharedVehicles[skinIndex+1] == null)
-			{
-				trafficVehicle.loadAssetsData();
 				sharedVehicles[skinIndex+1] = &trafficVehicle;
-			}
-			else  // if repeated spec/skin, use assets from other ("base") vehicle
-				trafficVehicle.loadAssetsData(sharedVehicles[skinIndex+1]);
+
+			const VehicleAssetsBinding binding = { &trafficVehicle, sharedVehicles[skinIndex+1], trafficVehicleIndex };
+			vehicleAssetsBindings.push_back(binding);
 
 			// random parameters
 			//FIXME number of lanes should be accounted for when deciding horizontal positions
 			//FIXME road shoulder size should be accounted for when deciding horizontal positions
-			trafficVehicle.position = futil::random_between_decimal(0.1, 0.9) * course.spec.lines.size() * course.spec.roadSegmentLength / coursePositionFactor;
-			trafficVehicle.horizontalPosition = (futil::random_between(-2, 3)/2.f) * 0.825 * course.spec.roadWidth / coursePositionFactor;
+			trafficVehicle.position = randomGenerator.betweenDecimal(0.1, 0.9) * course.spec.lines.size() * course.spec.roadSegmentLength / coursePositionFactor;
+			trafficVehicle.horizontalPosition = (randomGenerator.between(-2, 3)/2.f) * 0.825 * course.spec.roadWidth / coursePositionFactor;
 			trafficVehicle.body.simulationType = simulationType;
+			trafficVehicle.body.integrationMethod = Mechanics::getDefaultIntegrationMethod(simulationType);
 			trafficVehicle.body.reset();
-			trafficVehicle.body.engine.throttlePosition = futil::random_between_decimal(0.1, 0.4);
+			trafficVehicle.body.engine.throttlePosition = randomGenerator.betweenDecimal(0.1, 0.4);
 			trafficVehicle.body.automaticShiftingEnabled = true;
 		}
 
-		// apply screen scale to traffic sprites
-		foreach(vector<Pseudo3DVehicle*>&, sharedVehiclesOfSpec, vector< vector<Pseudo3DVehicle*> >, allSharedVehicles)
-			foreach(Pseudo3DVehicle*, sharedVehicle, vector<Pseudo3DVehicle*>, sharedVehiclesOfSpec)
-				if(sharedVehicle != null)
-					foreach(Sprite*, sprite, vector<Sprite*>, sharedVehicle->sprites)
-						sprite->scale *= GLOBAL_VEHICLE_SCALE_FACTOR;
-
 		foreach(Pseudo3DVehicle&, vehicle, vector<Pseudo3DVehicle>, trafficVehicles)
 			course.vehicles.push_back(&vehicle);
 	}
 
+	opponentVehicles.clear();
+	opponentRacingLines.clear();
+	opponentRacingLineIndexes.clear();
+	if(settings.opponentCount > 0)
+	{
+		opponentVehicles.resize(settings.opponentCount);
+		opponentRacingLineIndexes.resize(settings.opponentCount);
+
+		const vector<Pseudo3DVehicle::Spec>& vehicleSpecs = game.logic.getVehicleList();
+
+		// as with traffic, opponents with the same spec/skin share assets; they also share racing lines if they have the same spec
+		vector< vector<Pseudo3DVehicle*> > allSharedVehicles(vehicleSpecs.size());
+		for(unsigned i = 0; i < allSharedVehicles.size(); i++)
+			allSharedVehicles[i].resize(vehicleSpecs[i].alternateSprites.size()+1, null);
+
+		vector<int> racingLineIndexBySpec(vehicleSpecs.size(), -1);
+
+		// opponents' spec keys come after the traffic ones
+		const unsigned specKeyOffset = game.logic.getTrafficVehicleList().size();
+
+		for(unsigned i = 0; i < opponentVehicles.size(); i++)
+		{
+			const unsigned vehicleSpecIndex = randomGenerator.between(0, vehicleSpecs.size());
+			const Pseudo3DVehicle::Spec& spec = vehicleSpecs[vehicleSpecIndex];
+			vector<Pseudo3DVehicle*>& sharedVehicles = allSharedVehicles[vehicleSpecIndex];
+			const int skinIndex = spec.alternateSprites.empty()? -1 : randomGenerator.between(-1, spec.alternateSprites.size());
+			Pseudo3DVehicle& opponent = opponentVehicles[i];
+			opponent.setSpec(spec, skinIndex);
+
+			if(sharedVehicles[skinIndex+1] == null)
+				sharedVehicles[skinIndex+1] = &opponent;
+
+			const VehicleAssetsBinding binding = { &opponent, sharedVehicles[skinIndex+1], specKeyOffset + vehicleSpecIndex };
+			vehicleAssetsBindings.push_back(binding);
+
+			// starting grid, in rows of two, ahead of the player
+			opponent.position = courseStartPositionOffset + (i/2 + 1) * OPPONENT_GRID_ROW_SPACING;
+			opponent.horizontalPosition = (i % 2 == 0? -1 : 1) * OPPONENT_GRID_LATERAL_OFFSET_FACTOR * course.spec.roadWidth / coursePositionFactor;
+			opponent.corneringStiffness = computeCorneringStiffness(opponent.body);
+			opponent.body.simulationType = simulationType;
+			opponent.body.integrationMethod = Mechanics::getDefaultIntegrationMethod(simulationType);
+			opponent.body.reset();
+			opponent.body.automaticShiftingEnabled = true;
+
+			if(racingLineIndexBySpec[vehicleSpecIndex] == -1)
+			{
+				racingLineIndexBySpec[vehicleSpecIndex] = opponentRacingLines.size();
+				opponentRacingLines.push_back(computeRacingLine(opponent));
+			}
+			opponentRacingLineIndexes[i] = racingLineIndexBySpec[vehicleSpecIndex];
+		}
+
+		foreach(Pseudo3DVehicle&, opponent, vector<Pseudo3DVehicle>, opponentVehicles)
+			course.vehicles.push_back(&opponent);
+	}
+
 	playerVehicle.smokeSprite = null;
 	playerVehicle.setSpec(game.logic.getPickedVehicle(), game.logic.getPickedVehicleAlternateSpriteIndex());
-	playerVehicle.loadAssetsData();
+
+	// graphics of vehicles that load their own assets are loaded in a job each, and so is each of the player's engine sounds
+	assetLoadingQueue.add(new VehicleGraphicsLoadingJob(playerVehicle));
+	queueSounds(assetLoadingQueue, playerVehicle.engineSound.getSoundFilenames(), 0);
+
+	// other vehicles' engine sounds are only played through voices, so only synthesized ones are rendered now (once per spec)
+	vector<bool> isSpecKeyQueued(game.logic.getTrafficVehicleList().size() + game.logic.getVehicleList().size(), false);
+	foreach(const VehicleAssetsBinding&, binding, vector<VehicleAssetsBinding>, vehicleAssetsBindings)
+		if(binding.baseVehicle == binding.vehicle)
+		{
+			assetLoadingQueue.add(new VehicleGraphicsLoadingJob(*binding.vehicle));
+			if(not isSpecKeyQueued[binding.specKey])
+			{
+				assetLoadingQueue.add(new EngineSoundRenderingJob(binding.vehicle->engineSound));
+				isSpecKeyQueued[binding.specKey] = true;
+			}
+		}
+}
+
+void Pseudo3DRaceState::updateLoading()
+{
+	if(assetLoadingQueue.process(LOADING_TIME_SLICE))
+	{
+		finishLoading();
+		assetLoadingQueue.clear();  // releases the images held by the queue, which by now are also held by whoever uses them
+		loading = false;
+	}
+}
+
+void Pseudo3DRaceState::finishLoading()
+{
+	Display& display = game.getDisplay();
+	const FontSizer fs(display.getHeight());
+	const float displayWidth = display.getWidth(),
+				displayHeight = display.getHeight();
+
+	// all assets below were loaded by the loading queue, so these calls just take them from the caches
+	if(sndWheelspinBurnoutIntro == null)
+	{
+		Sound** const soundEffects[SOUND_EFFECT_COUNT] = {
+			&sndWheelspinBurnoutIntro, &sndWheelspinBurnoutLoop, &sndSideslipBurnoutIntro, &sndSideslipBurnoutLoop,
+			&sndRunningOnDirtLoop, &sndCrashImpact, &sndJumpImpact, &sndCountdownBuzzer, &sndCountdownBuzzerFinal
+		};
+		for(unsigned i = 0; i < SOUND_EFFECT_COUNT; i++)
+		{
+			*soundEffects[i] = SoundCache::acquire(SOUND_EFFECT_FILENAMES[i]);
+			(*soundEffects[i])->setVolume(game.logic.masterVolume);
+		}
+		sndCountdownBuzzer->setVolume(0.8 * game.logic.masterVolume);
+		sndCountdownBuzzerFinal->setVolume(0.8 * game.logic.masterVolume);
+
+		const VehicleSoundEffects::Sounds playerSounds = { sndWheelspinBurnoutIntro, sndWheelspinBurnoutLoop, sndSideslipBurnoutIntro, sndSideslipBurnoutLoop, sndRunningOnDirtLoop, sndCrashImpact };
+		playerSoundEffects.setSounds(playerSounds);
+
+		// a separate instance of the crash sound, so that it can play along with the player's (volume is set according to distance)
+		sndOtherVehiclesCrashImpact = SoundCache::acquire("assets/sound/crash.ogg", 1);
+		const VehicleSoundEffects::Sounds otherVehiclesSounds = { null, null, null, null, null, sndOtherVehiclesCrashImpact };
+		otherVehiclesSoundEffects.setSounds(otherVehiclesSounds);
+	}
+
+	course.loadAssetsData();
+
+	// acquired before releasing the previous one, so that it's not reloaded if it's the same landscape
+	Image* imgBackground = ImageCache::acquire(course.spec.landscapeFilename);
+	if(spriteBackground != null)
+	{
+		ImageCache::release(spriteBackground->image);
+		delete spriteBackground;
+	}
+	spriteBackground = new Sprite(imgBackground, imgBackground->getWidth(), imgBackground->getHeight(), 0.25, false);
+	spriteBackground->scale *= 0.2 * displayHeight / spriteBackground->height;
+
+	bgColor = course.spec.colorLandscape;
+	bgColorHorizon = course.spec.colorHorizon;
+
+	if(music != null)
+		delete music;
+
+	if(not course.spec.musicFilename.empty())
+	{
+		music = AudioLoader::takeMusic(course.spec.musicFilename);
+		music->setVolume(game.logic.masterVolume);
+	}
+	else
+		music = null;
+
+	// traffic and opponents graphics are packed into an atlas, so that they're drawn from a few textures instead of one for each spec/skin
+	// (the previous race's vehicles, which were drawn from the previous atlas, were already disposed of)
+	vehicleAtlas.clear();
+	vector<Image*> vehicleImages;
+	foreach(const VehicleAssetsBinding&, binding, vector<VehicleAssetsBinding>, vehicleAssetsBindings)
+		if(binding.baseVehicle == binding.vehicle)
+		{
+			const vector<Image*> images = binding.vehicle->getGraphicAssetsImages();
+			vehicleImages.insert(vehicleImages.end(), images.begin(), images.end());
+		}
+
+	vehicleAtlas.pack(vehicleImages);
+	foreach(const VehicleAssetsBinding&, binding, vector<VehicleAssetsBinding>, vehicleAssetsBindings)
+		if(binding.baseVehicle == binding.vehicle)
+			binding.vehicle->moveGraphicAssetsDataToAtlas(vehicleAtlas);
+
+	// the assets of the "base" vehicles are shared with the other vehicles of same spec/skin
+	vector<int> voiceProfileIndexBySpecKey(game.logic.getTrafficVehicleList().size() + game.logic.getVehicleList().size(), -1);
+	foreach(const VehicleAssetsBinding&, binding, vector<VehicleAssetsBinding>, vehicleAssetsBindings)
+	{
+		Pseudo3DVehicle& vehicle = *binding.vehicle;
+		if(binding.baseVehicle == binding.vehicle)  // graphics were already loaded by the loading queue; sounds are loaded by the voices
+		{
+			foreach(Sprite*, sprite, vector<Sprite*>, vehicle.sprites)
+				sprite->scale *= GLOBAL_VEHICLE_SCALE_FACTOR;
+		}
+		else
+			vehicle.loadAssetsData(binding.baseVehicle);
+
+		// the vehicle is just a template for the profile (specs whose synthesized sounds failed to render get no profile)
+		if(voiceProfileIndexBySpecKey[binding.specKey] == -1 and not vehicle.engineSound.getSoundFilenames().empty())
+			voiceProfileIndexBySpecKey[binding.specKey] = vehicleVoices.addProfile(vehicle.engineSound);
+		vehicleVoiceProfileIndexes.push_back(voiceProfileIndexBySpecKey[binding.specKey]);
+	}
+
+	// vehicles on the same course segment are drawn in this order, so sorting them by atlas page avoids switching between pages
+	std::stable_sort(course.vehicles.begin(), course.vehicles.end(), AtlasPageComparator(vehicleAtlas));
+
+	playerVehicle.loadSoundAssetsData();
 	playerVehicle.smokeSprite = spriteSmoke;
 	playerVehicle.engineSound.setVolume(game.logic.masterVolume);
 
@@ -363,13 +670,13 @@ void Pseudo3DRaceState::onEnter()
 		hudDialTachometer.boltRadius = 0.025 * displayHeight;
 		if(hudDialTachometer.pointerImage != null)
 		{
-			delete hudDialTachometer.pointerImage;
+			ImageCache::release(hudDialTachometer.pointerImage);
 			hudDialTachometer.pointerImage = null;
 			hudDialTachometer.pointerOffset = 0;
 		}
 		if(not settings.hudDialGaugePointerImageFilename.empty())
 		{
-			hudDialTachometer.pointerImage = new Image(settings.hudDialGaugePointerImageFilename);
+			hudDialTachometer.pointerImage = ImageCache::acquire(settings.hudDialGaugePointerImageFilename);
 			hudDialTachometer.pointerOffset = 45;
 		}
 	}
@@ -406,13 +713,13 @@ void Pseudo3DRaceState::onEnter()
 		hudDialSpeedometer.boltRadius = 0.025 * displayHeight;
 		if(hudDialSpeedometer.pointerImage != null)
 		{
-			delete hudDialSpeedometer.pointerImage;
+			ImageCache::release(hudDialSpeedometer.pointerImage);
 			hudDialSpeedometer.pointerImage = null;
 			hudDialSpeedometer.pointerOffset = 0;
 		}
 		if(not settings.hudDialGaugePointerImageFilename.empty())
 		{
-			hudDialSpeedometer.pointerImage = new Image(settings.hudDialGaugePointerImageFilename);
+			hudDialSpeedometer.pointerImage = ImageCache::acquire(settings.hudDialGaugePointerImageFilename);
 			hudDialSpeedometer.pointerOffset = 45;
 		}
 
@@ -581,7 +888,7 @@ void Pseudo3DRaceState::onEnter()
 		debugMode = true;
 	}
 
-	playerVehicle.corneringStiffness = 0.575 + 0.575/(1+exp(-0.4*(10.0 - (playerVehicle.body.mass*GRAVITY_ACCELERATION)/1000.0)));
+	playerVehicle.corneringStiffness = computeCorneringStiffness(playerVehicle.body);
 
 	verticalBackgroundParallax = 0;
 	playerVehicle.position = courseStartPositionOffset;
@@ -589,14 +896,30 @@ void Pseudo3DRaceState::onEnter()
 	playerVehicle.verticalSpeed = playerVehicle.strafeSpeed = 0;
 	playerVehicle.virtualOrientation = 0;
 	playerVehicle.body.simulationType = simulationType;
+	playerVehicle.body.integrationMethod = Mechanics::getDefaultIntegrationMethod(simulationType);
 	playerVehicle.body.reset();
 	playerVehicle.body.automaticShiftingEnabled = true;
 	playerVehicle.pseudoAngle = 0;
 	lapTimeCurrent = lapTimeBest = 0;
 	lapCurrent = 1;
 	acc0to60time = acc0to60clock = 0;
+	simulationTime = physicsTimeAccumulator = 0;
+	physicsStepCount = physicsStateHash = 0;
 
 	playerVehicle.isTireBurnoutOccurring = playerVehicle.onAir = playerVehicle.onLongAir = false;
+	playerSurfaceType = computeCurrentSurfaceType();
+
+	// all traffic starts with full physics, until the first LOD review
+	trafficSimulationLods.assign(trafficVehicles.size(), TRAFFIC_LOD_FULL);
+	trafficLodTimeAccumulator = 0;
+
+	const VehicleSweep emptySweep = { null, 0, 0, 0, 0 };
+	vehicleSweeps.assign(1 + trafficVehicles.size() + opponentVehicles.size(), emptySweep);
+	vehicleSweeps[0].vehicle = &playerVehicle;
+	for(unsigned i = 0; i < trafficVehicles.size(); i++)
+		vehicleSweeps[1+i].vehicle = &trafficVehicles[i];
+	for(unsigned i = 0; i < opponentVehicles.size(); i++)
+		vehicleSweeps[1+trafficVehicles.size()+i].vehicle = &opponentVehicles[i];
 
 	if(music != null) music->loop();
 	playerVehicle.engineSound.play();
@@ -604,19 +927,29 @@ void Pseudo3DRaceState::onEnter()
 
 void Pseudo3DRaceState::onLeave()
 {
+	if(loading)  // left before finishing loading
+	{
+		assetLoadingQueue.clear();
+		loading = false;
+	}
+
 	playerVehicle.engineSound.halt();
+	vehicleVoices.halt();
 	if(music != null) music->stop();
-	sndSideslipBurnoutIntro->stop();
-	sndSideslipBurnoutLoop->stop();
-	sndWheelspinBurnoutIntro->stop();
-	sndWheelspinBurnoutLoop->stop();
-	sndRunningOnDirtLoop->stop();
+	playerSoundEffects.halt();
+	otherVehiclesSoundEffects.halt();
 	sndCountdownBuzzer->stop();
 	sndCountdownBuzzerFinal->stop();
 }
 
 void Pseudo3DRaceState::render()
 {
+	if(loading)
+	{
+		drawLoadingScreen();
+		return;
+	}
+
 	const float displayWidth = course.drawAreaWidth,
 				displayHeight = course.drawAreaHeight;
 
@@ -710,6 +1043,23 @@ void Pseudo3DRaceState::render()
 }
 
 #define DEBUG_BUFFER_SIZE 512
+void Pseudo3DRaceState::drawLoadingScreen()
+{
+	const float displayWidth = course.drawAreaWidth,
+				displayHeight = course.drawAreaHeight;
+
+	game.getDisplay().clear();
+
+	const string caption = course.spec.toString();
+	fontTimers->drawText(caption, 0.5f*(displayWidth - fontTimers->getTextWidth(caption)), 0.4f*displayHeight, Color::WHITE);
+	fontSmall->drawText("Loading...", 0.5f*(displayWidth - fontSmall->getTextWidth("Loading...")), 0.4f*displayHeight + 1.2f*fontTimers->getTextHeight(), Color::LIGHT_GREY);
+
+	Rectangle progressBarBounds = { 0.25f*displayWidth, 0.6f*displayHeight, 0.5f*displayWidth, 0.02f*displayHeight };
+	Graphics::drawRectangle(progressBarBounds, Color::LIGHT_GREY);
+	progressBarBounds.w *= assetLoadingQueue.getProgress();
+	Graphics::drawFilledRectangle(progressBarBounds, Color::WHITE);
+}
+
 void Pseudo3DRaceState::drawDebugInfo()
 {
 	static char buffer[DEBUG_BUFFER_SIZE]; static const unsigned size = DEBUG_BUFFER_SIZE;
@@ -721,6 +1071,25 @@ void Pseudo3DRaceState::drawDebugInfo()
 	snprintf(buffer, size, "%d", game.getFpsCount());
 	fontDev->drawText(text=buffer, offset.x+30, offset.y, fgeal::Color::WHITE);
 
+	if(settings.deterministicPhysics)
+	{
+		fontDev->drawText("Step:", offset.x+150, offset.y, fgeal::Color::WHITE);
+		snprintf(buffer, size, "%lu (hash %08x)", physicsStepCount, physicsStateHash);
+		fontDev->drawText(text=buffer, offset.x+195, offset.y, fgeal::Color::WHITE);
+	}
+
+	if(not trafficVehicles.empty())
+	{
+		unsigned lodCount[3] = {0, 0, 0};
+		for(unsigned i = 0; i < trafficSimulationLods.size(); i++)
+			lodCount[trafficSimulationLods[i]]++;
+
+		offset.y += spacing;
+		fontDev->drawText("Traffic LOD:", offset.x, offset.y, fgeal::Color::WHITE);
+		snprintf(buffer, size, "%u full, %u cruise, %u analytical", lodCount[TRAFFIC_LOD_FULL], lodCount[TRAFFIC_LOD_CRUISE], lodCount[TRAFFIC_LOD_ANALYTICAL]);
+		fontDev->drawText(text=buffer, offset.x+90, offset.y, fgeal::Color::WHITE);
+	}
+
 
 	offset.y += spacingBig;
 	fontDev->drawText("Position:", offset.x, offset.y, fgeal::Color::WHITE);
@@ -864,20 +1233,181 @@ void Pseudo3DRaceState::drawDebugInfo()
 		snprintf(buffer, size, format.c_str(), i, playerVehicle.engineSound.getSoundData()[i]->getVolume(), playerVehicle.engineSound.getSoundData()[i]->getPlaybackSpeed());
 		fontDev->drawText(text=buffer, game.getDisplay().getWidth() - 200, game.getDisplay().getHeight()/2.0 - i*spacing, fgeal::Color::WHITE);
 	}
+
+	snprintf(buffer, size, "vehicle voices: %u/%u (%u sources)", vehicleVoices.getActiveVoiceCount(), vehicleVoices.getVoiceCount(), (unsigned) vehicleSoundSources.size());
+	fontDev->drawText(text=buffer, game.getDisplay().getWidth() - 200, game.getDisplay().getHeight()/2.0 + spacing, fgeal::Color::WHITE);
+
+	snprintf(buffer, size, "vehicle atlas pages: %u", vehicleAtlas.getPageCount());
+	fontDev->drawText(text=buffer, game.getDisplay().getWidth() - 200, game.getDisplay().getHeight()/2.0 + 2*spacing, fgeal::Color::WHITE);
 }
 
-static const float LONGITUDINAL_SLIP_RATIO_BURN_RUBBER = 0.2,  // 20%
-		MAXIMUM_PHYSICS_DELTA_TIME = 0.01;
+static const float LONGITUDINAL_SLIP_RATIO_BURN_RUBBER = 0.2;  // 20%
 
 void Pseudo3DRaceState::update(float delta)
 {
-	float physicsDelta = delta;
-	while(physicsDelta > MAXIMUM_PHYSICS_DELTA_TIME)  // process delta too large in smaller delta steps
+	if(loading)
+	{
+		updateLoading();
+		return;
+	}
+
+	if(settings.deterministicPhysics)
+	{
+		// process the elapsed time in fixed steps (carrying the remainder over to the next frame), so results don't depend on frame rate
+		physicsTimeAccumulator += delta;
+		while(physicsTimeAccumulator >= DETERMINISTIC_PHYSICS_TIME_STEP)
+		{
+			handlePhysics(DETERMINISTIC_PHYSICS_TIME_STEP);
+			handleRaceLogic(DETERMINISTIC_PHYSICS_TIME_STEP);
+			physicsTimeAccumulator -= DETERMINISTIC_PHYSICS_TIME_STEP;
+			physicsStepCount++;
+			physicsStateHash = computePhysicsStateHash();
+		}
+	}
+	else
+	{
+		// all vehicles share the same simulation type and integration method, so the player's one dictates the time step
+		const float maximumPhysicsDeltaTime = Mechanics::getMaximumTimeStep(simulationType, playerVehicle.body.integrationMethod);
+
+		float physicsDelta = delta;
+		while(physicsDelta > maximumPhysicsDeltaTime)  // process delta too large in smaller delta steps
+		{
+			handlePhysics(maximumPhysicsDeltaTime);
+			physicsDelta -= maximumPhysicsDeltaTime;
+		}
+		handlePhysics(physicsDelta);
+		handleRaceLogic(delta);
+	}
+
+	// update bg parallax
+	verticalBackgroundParallax -= 2*playerVehicle.body.slopeAngle;
+
+	// engine sound control
+	playerVehicle.engineSound.update(playerVehicle.body.engine.rpm, playerVehicle.body.engine.throttlePosition);
+	updateVehicleVoices();
+
+	// wheelspin logic control
+	const bool isPlayerWheelspinOccurring = (
+		(playerVehicle.body.simulationType == Mechanics::SIMULATION_TYPE_SLIPLESS
+			and
+			(
+				// fake burnout mode
+				playerVehicle.body.engine.gear == 1
+				and playerVehicle.body.engine.rpm < 0.5*playerVehicle.body.engine.maxRpm
+				and isPlayerAccelerating()
+			)
+		)
+		or
+		(playerVehicle.body.simulationType == Mechanics::SIMULATION_TYPE_WHEEL_LOAD_CAP
+			and
+			(
+				// burnout based on capped drive force
+				(playerVehicle.body.getDriveForce() < 0.75 * playerVehicle.body.engine.getDriveTorque() / playerVehicle.body.tireRadius)
+				and playerVehicle.body.engine.gear == 1  // but limited to first gear.
+			)
+		)
+		or
+		(playerVehicle.body.simulationType == Mechanics::SIMULATION_TYPE_PACEJKA_BASED
+			and
+			(
+				// burnout based on real slip ratio
+				fabs(playerVehicle.body.slipRatio) > LONGITUDINAL_SLIP_RATIO_BURN_RUBBER
+				and fabs(playerVehicle.body.speed) > 1.0
+			)
+		)
+	);
+
+	const bool isPlayerSideslipOccurring = (
+			fabs(playerVehicle.body.speed) > MINIMUM_SPEED_TO_SIDESLIP
+		and MAXIMUM_STRAFE_SPEED_FACTOR * playerVehicle.corneringStiffness - fabs(playerVehicle.strafeSpeed) < 1
+	);
+
+	// tire noises only occur on dry asphalt
+	const VehicleSoundEffects::TireState playerTireState = (playerSurfaceType != SURFACE_TYPE_DRY_ASPHALT? VehicleSoundEffects::TIRE_STATE_GRIPPING
+														  : isPlayerWheelspinOccurring? VehicleSoundEffects::TIRE_STATE_WHEELSPIN
+														  : isPlayerSideslipOccurring? VehicleSoundEffects::TIRE_STATE_SIDESLIP
+														  : VehicleSoundEffects::TIRE_STATE_GRIPPING);
+
+	playerSoundEffects.update(playerTireState, playerSurfaceType != SURFACE_TYPE_DRY_ASPHALT and fabs(playerVehicle.body.speed) > 1);
+	playerVehicle.isTireBurnoutOccurring = (playerTireState != VehicleSoundEffects::TIRE_STATE_GRIPPING);
+
+	updateVehicleSoundEffects();
+}
+
+// computes the longitudinal offset (taking the shortest way around the course) and the distance from the player's vehicle to the given one
+void Pseudo3DRaceState::computeOffsetFromPlayer(const Pseudo3DVehicle& vehicle, float& longitudinalOffset, float& distance) const
+{
+	const float courseLength = course.spec.lines.size() * course.spec.roadSegmentLength / coursePositionFactor,
+				lateralOffset = vehicle.horizontalPosition - playerVehicle.horizontalPosition;
+
+	longitudinalOffset = vehicle.position - playerVehicle.position;
+	if(longitudinalOffset > 0.5f*courseLength) longitudinalOffset -= courseLength;
+	else if(longitudinalOffset < -0.5f*courseLength) longitudinalOffset += courseLength;
+
+	distance = sqrt(longitudinalOffset*longitudinalOffset + lateralOffset*lateralOffset);
+}
+
+// updates the engine sounds of traffic and opponents, as heard from the player's position
+void Pseudo3DRaceState::updateVehicleVoices()
+{
+	const unsigned trafficCount = trafficVehicles.size();
+
+	vehicleSoundSources.clear();
+	for(unsigned i = 0; i < vehicleVoiceProfileIndexes.size(); i++)
+	{
+		if(vehicleVoiceProfileIndexes[i] < 0)
+			continue;
+
+		const Pseudo3DVehicle& vehicle = (i < trafficCount? trafficVehicles[i] : opponentVehicles[i - trafficCount]);
+
+		float offset, distance;
+		computeOffsetFromPlayer(vehicle, offset, distance);
+		const float relativeSpeed = vehicle.body.speed - playerVehicle.body.speed;  // along the course
+
+		const EngineVoiceManager::Source source = {
+			static_cast<unsigned>(vehicleVoiceProfileIndexes[i]), distance,
+			distance > 0? -relativeSpeed * offset / distance : 0,  // approaching if ahead and slower, or behind and faster
+			vehicle.body.speed, vehicle.body.engine.rpm, vehicle.body.engine.throttlePosition
+		};
+		vehicleSoundSources.push_back(source);
+	}
+
+	vehicleVoices.update(vehicleSoundSources);
+}
+
+// plays the crash sounds of the player and of other vehicles (crashes are flagged by the physics)
+void Pseudo3DRaceState::updateVehicleSoundEffects()
+{
+	if(playerVehicle.isCrashing)
 	{
-		handlePhysics(MAXIMUM_PHYSICS_DELTA_TIME);
-		physicsDelta -= MAXIMUM_PHYSICS_DELTA_TIME;
+		playerSoundEffects.playCrash();
+		playerVehicle.isCrashing = false;
 	}
-	handlePhysics(physicsDelta);
+
+	// crashes between other vehicles are heard as a single one, at the distance of the nearest
+	float crashGain = 0, offset, distance;
+	for(unsigned i = 0; i < trafficVehicles.size() + opponentVehicles.size(); i++)
+	{
+		Pseudo3DVehicle& vehicle = (i < trafficVehicles.size()? trafficVehicles[i] : opponentVehicles[i - trafficVehicles.size()]);
+		if(vehicle.isCrashing)
+		{
+			computeOffsetFromPlayer(vehicle, offset, distance);
+			crashGain = std::max(crashGain, EngineVoiceManager::computeGain(distance));
+			vehicle.isCrashing = false;
+		}
+	}
+
+	if(crashGain > 0)
+	{
+		otherVehiclesSoundEffects.setVolume(crashGain * game.logic.masterVolume);
+		otherVehiclesSoundEffects.playCrash();
+	}
+}
+
+// handles the race progress (course looping, laps, intro and finish scenes); in deterministic physics mode, called once per time step
+void Pseudo3DRaceState::handleRaceLogic(float delta)
+{
+	simulationTime += delta;
 
 	// course looping control
 	const float courseLength = course.spec.lines.size() * course.spec.roadSegmentLength / coursePositionFactor;
@@ -888,9 +1418,6 @@ void Pseudo3DRaceState::update(float delta)
 	while(playerVehicle.position < 0)  // negative position is not allowed, take backwards position modulus
 		playerVehicle.position += courseLength;
 
-	// update bg parallax
-	verticalBackgroundParallax -= 2*playerVehicle.body.slopeAngle;
-
 	// scene control
 	if(onSceneIntro)
 	{
@@ -958,108 +1485,23 @@ void Pseudo3DRaceState::update(float delta)
 		}
 	}
 
-	// engine sound control
-	playerVehicle.engineSound.update(playerVehicle.body.engine.rpm);
-
 	// 0-60 time control (debug)
 	if(acc0to60time == 0)
 	{
 		if(playerVehicle.body.engine.throttlePosition > 0 and playerVehicle.body.speed > 0 and acc0to60clock == 0)
-			acc0to60clock = fgeal::uptime();
+			acc0to60clock = simulationTime;
 		else if(playerVehicle.body.engine.throttlePosition < 0 and acc0to60clock != 0)
 			acc0to60clock = 0;
 		else if(playerVehicle.body.engine.throttlePosition > 0 and playerVehicle.body.speed * 3.6 > 96)
-			acc0to60time = fgeal::uptime() - acc0to60clock;
-	}
-
-	// wheelspin logic control
-	const bool isPlayerWheelspinOccurring = (
-		(playerVehicle.body.simulationType == Mechanics::SIMULATION_TYPE_SLIPLESS
-			and
-			(
-				// fake burnout mode
-				playerVehicle.body.engine.gear == 1
-				and playerVehicle.body.engine.rpm < 0.5*playerVehicle.body.engine.maxRpm
-				and isPlayerAccelerating()
-			)
-		)
-		or
-		(playerVehicle.body.simulationType == Mechanics::SIMULATION_TYPE_WHEEL_LOAD_CAP
-			and
-			(
-				// burnout based on capped drive force
-				(playerVehicle.body.getDriveForce() < 0.75 * playerVehicle.body.engine.getDriveTorque() / playerVehicle.body.tireRadius)
-				and playerVehicle.body.engine.gear == 1  // but limited to first gear.
-			)
-		)
-		or
-		(playerVehicle.body.simulationType == Mechanics::SIMULATION_TYPE_PACEJKA_BASED
-			and
-			(
-				// burnout based on real slip ratio
-				fabs(playerVehicle.body.slipRatio) > LONGITUDINAL_SLIP_RATIO_BURN_RUBBER
-				and fabs(playerVehicle.body.speed) > 1.0
-			)
-		)
-	);
-
-	const bool isPlayerSideslipOccurring = (
-			fabs(playerVehicle.body.speed) > MINIMUM_SPEED_TO_SIDESLIP
-		and MAXIMUM_STRAFE_SPEED_FACTOR * playerVehicle.corneringStiffness - fabs(playerVehicle.strafeSpeed) < 1
-	);
-
-	if(isPlayerWheelspinOccurring and getCurrentSurfaceType() == SURFACE_TYPE_DRY_ASPHALT)
-	{
-		if(sndSideslipBurnoutIntro->isPlaying()) sndSideslipBurnoutIntro->stop();
-		if(sndSideslipBurnoutLoop->isPlaying()) sndSideslipBurnoutLoop->stop();
-
-		if(not playerVehicle.isTireBurnoutOccurring)
-			sndWheelspinBurnoutIntro->play();
-		else if(not sndWheelspinBurnoutIntro->isPlaying() and not sndWheelspinBurnoutLoop->isPlaying())
-			sndWheelspinBurnoutLoop->loop();
-
-		playerVehicle.isTireBurnoutOccurring = true;
-	}
-	else if(isPlayerSideslipOccurring and getCurrentSurfaceType() == SURFACE_TYPE_DRY_ASPHALT)
-	{
-		if(sndWheelspinBurnoutIntro->isPlaying()) sndWheelspinBurnoutIntro->stop();
-		if(sndWheelspinBurnoutLoop->isPlaying()) sndWheelspinBurnoutLoop->stop();
-
-		if(not playerVehicle.isTireBurnoutOccurring)
-			sndSideslipBurnoutIntro->play();
-		else if(not sndSideslipBurnoutIntro->isPlaying() and not sndSideslipBurnoutLoop->isPlaying())
-			sndSideslipBurnoutLoop->loop();
-
-		playerVehicle.isTireBurnoutOccurring = true;
-	}
-	else
-	{
-		if(sndWheelspinBurnoutIntro->isPlaying()) sndWheelspinBurnoutIntro->stop();
-		if(sndWheelspinBurnoutLoop->isPlaying()) sndWheelspinBurnoutLoop->stop();
-		if(sndSideslipBurnoutIntro->isPlaying()) sndSideslipBurnoutIntro->stop();
-		if(sndSideslipBurnoutLoop->isPlaying()) sndSideslipBurnoutLoop->stop();
-		playerVehicle.isTireBurnoutOccurring = false;
-	}
-
-	if(getCurrentSurfaceType() != SURFACE_TYPE_DRY_ASPHALT and fabs(playerVehicle.body.speed) > 1)
-	{
-		if(not sndRunningOnDirtLoop->isPlaying())
-			sndRunningOnDirtLoop->loop();
-	}
-	else if(sndRunningOnDirtLoop->isPlaying())
-		sndRunningOnDirtLoop->stop();
-
-	if(playerVehicle.isCrashing)
-	{
-		if(not sndCrashImpact->isPlaying())
-			sndCrashImpact->play();
-
-		playerVehicle.isCrashing = false;
+			acc0to60time = simulationTime - acc0to60clock;
 	}
 }
 
 void Pseudo3DRaceState::onKeyPressed(Keyboard::Key key)
 {
+	if(loading)
+		return;
+
 	if(key == controlKeyShiftUp)
 		shiftGear(playerVehicle.body.engine.gear+1);
 	else if(key == controlKeyShiftDown)
@@ -1087,6 +1529,8 @@ void Pseudo3DRaceState::onKeyPressed(Keyboard::Key key)
 			countdownBuzzerCounter = 5;
 			playerVehicle.onAir = playerVehicle.onLongAir = false;
 			acc0to60time = acc0to60clock = 0;
+			simulationTime = physicsTimeAccumulator = 0;
+			physicsStepCount = physicsStateHash = 0;
 			break;
 		case Keyboard::KEY_T:
 			playerVehicle.body.automaticShiftingEnabled = !playerVehicle.body.automaticShiftingEnabled;
@@ -1122,6 +1566,9 @@ void Pseudo3DRaceState::onKeyPressed(Keyboard::Key key)
 
 void Pseudo3DRaceState::onJoystickButtonPressed(unsigned joystick, unsigned button)
 {
+	if(loading)
+		return;
+
 	if(button == controlJoystickKeyShiftUp)
 		shiftGear(playerVehicle.body.engine.gear+1);
 	else if(button == controlJoystickKeyShiftDown)
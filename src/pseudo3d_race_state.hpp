@@ -11,9 +11,17 @@
 
 #include "course.hpp"
 #include "vehicle.hpp"
+#include "asset_loading_queue.hpp"
 
 #include "automotive/engine_sound.hpp"
 
+#include "audio/engine_voice_manager.hpp"
+#include "audio/vehicle_sound_effects.hpp"
+
+#include "racing/racing_line.hpp"
+
+#include "gfx/texture_atlas.hpp"
+
 #include "gui/race_hud.hpp"
 
 #include "futil/language.hpp"
@@ -41,7 +49,11 @@ class Pseudo3DRaceState extends public fgeal::Game::State
 				 *sndSideslipBurnoutIntro, *sndSideslipBurnoutLoop,
 				 *sndRunningOnDirtLoop,
 				 *sndCrashImpact, *sndJumpImpact,
-				 *sndCountdownBuzzer, *sndCountdownBuzzerFinal;
+				 *sndCountdownBuzzer, *sndCountdownBuzzerFinal,
+				 *sndOtherVehiclesCrashImpact;
+
+	// tire, surface and crash sound effects of the player's vehicle, and crash sound effects of other vehicles
+	VehicleSoundEffects playerSoundEffects, otherVehiclesSoundEffects;
 
 	fgeal::Color bgColor, bgColorHorizon;
 	fgeal::Sprite* spriteSmoke, *spriteBackground;
@@ -141,14 +153,41 @@ class Pseudo3DRaceState extends public fgeal::Game::State
 		HudType hudType;
 		bool useCachedDialGauge;
 		std::string hudDialGaugePointerImageFilename;
+		bool deterministicPhysics;  // if true, physics runs with a fixed time step and traffic is placed using 'randomSeed'
+		unsigned randomSeed;
+		unsigned opponentCount;
 	};
 
+	// the time step used by the physics when in deterministic mode
+	static const float DETERMINISTIC_PHYSICS_TIME_STEP;
+
+	// the default value of 'coursePositionFactor' (offline tools simulating races use it as well)
+	static const float DEFAULT_COURSE_POSITION_FACTOR;
+
+	// the tire friction and rolling resistance coefficients of the road's surface (dry asphalt)
+	static const float TIRE_FRICTION_COEFFICIENT_DRY_ASPHALT, ROLLING_RESISTANCE_COEFFICIENT_DRY_ASPHALT;
+
+	// the maximum lateral (strafe) speed that a vehicle with the given body can use to counter curve pull
+	static float getMaximumStrafeSpeed(const Mechanics& body);
+
+	// sets the throttle and brakes of an AI-driven vehicle (with the given body, on the given segment), so that it follows the given target speed
+	// of each segment of the course; this is the speed control of opponents, also used by tools that simulate them
+	static void updateOpponentSpeedControl(Mechanics& body, unsigned segmentIndex, const std::vector<float>& targetSpeed, const Pseudo3DCourse::Spec& courseSpec, float coursePositionFactor);
+
 	private:
 	RaceSettings settings;
 
 	float lapTimeCurrent, lapTimeBest;
 	unsigned lapCurrent;
 
+	// simulated time elapsed since the race started (as opposed to real time)
+	double simulationTime;
+
+	// deterministic physics mode stuff
+	float physicsTimeAccumulator;  // simulated time not yet processed by a fixed time step
+	unsigned long physicsStepCount;  // the number of fixed time steps processed so far
+	unsigned physicsStateHash;  // the hash of the physics state after the last fixed time step
+
 	//debug
 	float acc0to60clock, acc0to60time;
 
@@ -158,6 +197,67 @@ class Pseudo3DRaceState extends public fgeal::Game::State
 
 	std::vector<Pseudo3DVehicle> trafficVehicles;
 
+	// simulation level of detail (LOD) of traffic vehicles, chosen by their distance to the player
+	enum TrafficSimulationLod
+	{
+		TRAFFIC_LOD_FULL,  // full physics, every step (near and visible vehicles)
+		TRAFFIC_LOD_CRUISE,  // speed and position integrated every step, with acceleration sampled only on every LOD review
+		TRAFFIC_LOD_ANALYTICAL  // advanced at once on every LOD review, assuming constant acceleration
+	};
+
+	// the LOD of each traffic vehicle (same order as trafficVehicles)
+	std::vector<TrafficSimulationLod> trafficSimulationLods;
+
+	// simulated time since the last traffic LOD review
+	float trafficLodTimeAccumulator;
+
+	// AI-driven opponent vehicles
+	std::vector<Pseudo3DVehicle> opponentVehicles;
+
+	// the racing lines followed by opponents (one for each distinct vehicle spec among them), computed once when the course is loaded
+	std::vector<RacingLine> opponentRacingLines;
+
+	// the index of the racing line followed by each opponent (same order as opponentVehicles)
+	std::vector<unsigned> opponentRacingLineIndexes;
+
+	// plays the engine sounds of traffic and opponents, as heard by the player (the player's own engine sound is played directly)
+	EngineVoiceManager vehicleVoices;
+
+	// the voice profile of each traffic vehicle and opponent (in this order), or -1 if the vehicle has no engine sound
+	std::vector<int> vehicleVoiceProfileIndexes;
+
+	// the engine sound sources of traffic and opponents with engine sound, refilled on every update
+	std::vector<EngineVoiceManager::Source> vehicleSoundSources;
+
+	// the vehicle whose assets each traffic vehicle and opponent (in this order) shares, which is itself if it's the one loading them,
+	// and a key identifying its spec (vehicles with the same key share a voice profile)
+	struct VehicleAssetsBinding
+	{
+		Pseudo3DVehicle* vehicle, *baseVehicle;
+		unsigned specKey;
+	};
+
+	std::vector<VehicleAssetsBinding> vehicleAssetsBindings;
+
+	// the pages into which the graphics of traffic and opponents are packed, so that they're drawn from a few textures
+	TextureAtlas vehicleAtlas;
+
+	// assets are loaded in time slices after onEnter(), while a loading screen is shown (see updateLoading())
+	AssetLoadingQueue assetLoadingQueue;
+	bool loading;
+
+	// the course interval swept by a vehicle during a physics step, for collision detection
+	struct VehicleSweep
+	{
+		Pseudo3DVehicle* vehicle;
+		float previousPosition;  // the vehicle's position before the step
+		float displacement;  // how much the vehicle moved during the step (negative if backwards)
+		float start, length;  // the swept interval (start is wrapped within the course length), including the vehicle's own extent
+	};
+
+	// the swept intervals of all vehicles on the course (player's and traffic), kept sorted by start
+	std::vector<VehicleSweep> vehicleSweeps;
+
 	// HUD stuff --------------------------------------------------------------
 	Pseudo3DCourse::Map minimap;
 
@@ -210,6 +310,19 @@ class Pseudo3DRaceState extends public fgeal::Game::State
 		SURFACE_TYPE_WATER
 	};
 
+	// the surface type under the player vehicle, classified once per physics step
+	SurfaceType playerSurfaceType;
+
+	// physics coefficients of a course segment, precomputed when the course is loaded
+	struct SegmentPhysics
+	{
+		float slopeAngle, slopeAngleSine;  // the angle (and its sine) of the slope from the previous segment to this one
+		float curvePullFactor;  // the curve pull on a vehicle on this segment, per squared speed
+	};
+
+	// the precomputed physics coefficients of each course segment
+	std::vector<SegmentPhysics> segmentPhysics;
+
 	bool debugMode;
 
 	bool isPlayerAccelerating();
@@ -231,16 +344,37 @@ class Pseudo3DRaceState extends public fgeal::Game::State
 	virtual void update(float delta);
 	virtual void render();
 
+	/** Returns the hash of the physics state after the last time step, when in deterministic physics mode. Equal hashes (at the same
+	 *  step count) indicate that two runs are identical up to that point, which is useful for validating replays and comparing runs. */
+	inline unsigned getPhysicsStateHash() const { return physicsStateHash; }
+
+	/** Returns the number of time steps processed so far, when in deterministic physics mode. */
+	inline unsigned long getPhysicsStepCount() const { return physicsStepCount; }
+
 	virtual void onKeyPressed(fgeal::Keyboard::Key);
 	virtual void onJoystickButtonPressed(unsigned joystick, unsigned button);
 
 	private:
+	void updateLoading();
+	void finishLoading();
+	void drawLoadingScreen();
 	void handlePhysics(float delta);
+	void handleRaceLogic(float delta);
+	void handleOpponentDriving(Pseudo3DVehicle& opponent, const RacingLine& racingLine, float delta);
+	void updateTrafficSimulationLod(float elapsed, float delta);
+	void updateVehicleVoices();
+	void updateVehicleSoundEffects();
+	void computeOffsetFromPlayer(const Pseudo3DVehicle& vehicle, float& longitudinalOffset, float& distance) const;
+	void handleVehicleCollisions();
+	void handleVehicleCollision(const VehicleSweep& sweep, const VehicleSweep& otherSweep);
+	unsigned computePhysicsStateHash() const;
+	void computeSegmentPhysics();
+	RacingLine computeRacingLine(const Pseudo3DVehicle& vehicle);
 	void drawDebugInfo();
 
 	void shiftGear(int gear);
 
-	SurfaceType getCurrentSurfaceType();
+	SurfaceType computeCurrentSurfaceType();
 	float getTireKineticFrictionCoefficient();
 	float getTireRollingResistanceCoefficient();
 };
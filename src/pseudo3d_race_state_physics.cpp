@@ -5,6 +5,8 @@
  *      Author: carlosfaruolo
  */
 
+#include "automotive/strict_floating_point.hpp"  // must come first
+
 #include "pseudo3d_race_state.hpp"
 
 #include "carse_game.hpp"
@@ -12,9 +14,8 @@
 
 using std::vector;
 
-#include <iostream>
-using std::cout; using std::endl;
-// XXX DEBUG
+#include <cstring>
+#include <algorithm>
 
 /* Tire coefficients
  *
@@ -37,29 +38,59 @@ using std::cout; using std::endl;
 
 #define GRAVITY_ACCELERATION Mechanics::GRAVITY_ACCELERATION
 
-static const float TIRE_FRICTION_COEFFICIENT_DRY_ASPHALT = 0.85,
-				   TIRE_FRICTION_COEFFICIENT_GRASS = 0.42,
-				   ROLLING_RESISTANCE_COEFFICIENT_DRY_ASPHALT = 0.013,
+const float Pseudo3DRaceState::TIRE_FRICTION_COEFFICIENT_DRY_ASPHALT = 0.85,
+		   Pseudo3DRaceState::ROLLING_RESISTANCE_COEFFICIENT_DRY_ASPHALT = 0.013;
+
+static const float TIRE_FRICTION_COEFFICIENT_GRASS = 0.42,
 				   ROLLING_RESISTANCE_COEFFICIENT_GRASS = 0.100,
 				   COLLISION_RESTITUTION_COEFFICIENT = 0.5,
 
 				   PSEUDO_ANGLE_MAX = 1.0,
 				   STEERING_SPEED = 2.0,
 				   MINIMUM_SPEED_ALLOW_TURN = 1.0/36.0,  // == 1kph
-				   MINIMUM_SPEED_CORNERING_LEECH = 10;  // == 36kph
+				   MINIMUM_SPEED_CORNERING_LEECH = 10,  // == 36kph
+				   PROP_COLLISION_CLEARANCE = 0.01,  // how far out of a prop's segment (as a fraction of the segment length) a car is put back
+				   JUMP_TAKEOFF_MARGIN = 0.05,  // how high above the road (in meters) a car must be to leave the ground, when not going over a crest
+
+				   OPPONENT_THROTTLE_GAIN = 0.5,  // throttle position per m/s below the target speed
+				   OPPONENT_BRAKE_GAIN = 1.0,  // brake pedal position per m/s above the target speed
+				   OPPONENT_LOOKAHEAD_TIME = 0.1,  // how far ahead (in seconds, at the current speed) opponents look for their target speed
+				   OPPONENT_STEERING_GAIN = 2.0,  // strafe speed per unit of distance to the racing line
+
+				   TRAFFIC_LOD_UPDATE_INTERVAL = 0.1,  // how often (in simulated seconds) traffic LOD is reviewed and far traffic is advanced
+				   TRAFFIC_LOD_HYSTERESIS_FACTOR = 1.25;  // how much farther than the promotion distance a vehicle must be to get demoted
+
+// returns the given position wrapped within the course length (the player's position may be slightly off it until the race logic wraps it)
+static inline float getWrappedPosition(float position, float courseLength)
+{
+	if(position >= courseLength) return position - courseLength;
+	if(position < 0) return position + courseLength;
+	return position;
+}
 
 void Pseudo3DRaceState::handlePhysics(float delta)
 {
 	const unsigned courseSegmentIndex = static_cast<int>(playerVehicle.position * coursePositionFactor / course.spec.roadSegmentLength) % course.spec.lines.size();
 	const CourseSpec::Segment& courseSegment = course.spec.lines[courseSegmentIndex];
+	const SegmentPhysics& segmentCoefficients = segmentPhysics[courseSegmentIndex];
 	const float corneringForceLeechFactor = playerVehicle.body.speed > MINIMUM_SPEED_CORNERING_LEECH? (playerVehicle.body.vehicleType == Mechanics::TYPE_BIKE? 0.4 : 0.5) : 0,
 				wheelAngleFactor = 1 - corneringForceLeechFactor*fabs(playerVehicle.pseudoAngle)/PSEUDO_ANGLE_MAX,
 				maxStrafeSpeed = MAXIMUM_STRAFE_SPEED_FACTOR * playerVehicle.corneringStiffness;
 
+	playerSurfaceType = computeCurrentSurfaceType();
+
+	// record positions before the step, so collisions can be checked over the whole interval swept during it
+	const float playerPreviousPosition = playerVehicle.position;
+	for(unsigned i = 0; i < vehicleSweeps.size(); i++)
+		vehicleSweeps[i].previousPosition = vehicleSweeps[i].vehicle->position;
+
 	playerVehicle.body.tireFrictionFactor = playerVehicle.onAir? 0 : getTireKineticFrictionCoefficient();
 	playerVehicle.body.rollingResistanceFactor = playerVehicle.onAir? 0 : getTireRollingResistanceCoefficient();
 	playerVehicle.body.arbitraryForceFactor = wheelAngleFactor;
-	playerVehicle.body.slopeAngle = playerVehicle.onAir? 0 : atan2(courseSegment.y - playerVehicle.verticalPosition, course.spec.roadSegmentLength);
+	if(playerVehicle.onAir)
+		playerVehicle.body.setSlopeAngle(0, 0);
+	else
+		playerVehicle.body.setSlopeAngle(segmentCoefficients.slopeAngle, segmentCoefficients.slopeAngleSine);
 
 	if(onSceneIntro)
 		playerVehicle.body.engine.gear = 0;
@@ -97,14 +128,7 @@ void Pseudo3DRaceState::handlePhysics(float delta)
 		playerVehicle.strafeSpeed = maxStrafeSpeed * sgn(playerVehicle.strafeSpeed);
 
 	// update curve pull
-//	const float curvatureFactor = 2 * sin(0.5 * courseSegment.curve);  // correct formula according to theory, assuming 'courseSegment.curve' is the degree of curvature, in radians. however it does not behave nicely...
-//	const float curvatureFactor = 2 * sin(atan(0.5 * courseSegment.curve));
-//	const float curvatureFactor = 2 * sin(atan(0.4 * pow2(courseSegment.curve))) * sgn(courseSegment.curve);
-//	const float curvatureFactor = sqrt(2 * courseSegment.curve) * atan(0.5 * courseSegment.curve);
-//	const float curvatureFactor = sqrt(2 * fabs(courseSegment.curve)) * atan(0.25 * pow2(courseSegment.curve)) * sgn(courseSegment.curve);
-//	const float curvatureFactor = 1.25 * courseSegment.curve - atan(courseSegment.curve);
-	const float curvatureFactor = 1.25 * courseSegment.curve;
-	playerVehicle.curvePull = pow2(playerVehicle.body.speed) * curvatureFactor / course.spec.roadSegmentLength;
+	playerVehicle.curvePull = pow2(playerVehicle.body.speed) * segmentCoefficients.curvePullFactor;
 
 	// update strafe position
 	playerVehicle.horizontalPosition += (playerVehicle.strafeSpeed - playerVehicle.curvePull)*delta;
@@ -114,25 +138,36 @@ void Pseudo3DRaceState::handlePhysics(float delta)
 
 	if(enableJumpSimulation)
 	{
+		// height of the road under the car, interpolated along the grade of its current segment (the one between the previous segment and it)
+		const float courseLength = course.spec.lines.size() * course.spec.roadSegmentLength / coursePositionFactor,
+					segmentPosition = getWrappedPosition(playerVehicle.position, courseLength) * coursePositionFactor / course.spec.roadSegmentLength;
+		const unsigned currentSegmentIndex = static_cast<unsigned>(segmentPosition) % course.spec.lines.size();
+		const float roadHeight = course.spec.lines[currentSegmentIndex].y - (1 - fractional_part(segmentPosition)) * course.spec.getSlopeRise(currentSegmentIndex);
+
+		// the grade falls away when the car moves onto a segment whose grade is lower than the one it was on (i.e. it goes over a crest)
+		const bool overCrest = currentSegmentIndex == (courseSegmentIndex + 1) % course.spec.lines.size()
+							   and segmentPhysics[currentSegmentIndex].slopeAngleSine < segmentCoefficients.slopeAngleSine;
+
 		if(playerVehicle.onAir)
 			playerVehicle.verticalSpeed -= 10 * GRAVITY_ACCELERATION * delta;
 		else
-			playerVehicle.verticalSpeed = fabs(playerVehicle.body.speed) * sin(playerVehicle.body.slopeAngle);
+			playerVehicle.verticalSpeed = fabs(playerVehicle.body.speed) * segmentCoefficients.slopeAngleSine;
 
 		playerVehicle.verticalPosition += coursePositionFactor * playerVehicle.verticalSpeed * delta;
 
-		if(courseSegment.y >= playerVehicle.verticalPosition)
+		const float heightAboveRoad = playerVehicle.verticalPosition - roadHeight;
+		if(heightAboveRoad > 0 and (playerVehicle.onAir or overCrest or heightAboveRoad > JUMP_TAKEOFF_MARGIN * coursePositionFactor))
 		{
-			playerVehicle.verticalPosition = courseSegment.y;
-			if(playerVehicle.onLongAir)
-				sndJumpImpact->play();
-			playerVehicle.onAir = playerVehicle.onLongAir = false;
+			playerVehicle.onAir = true;
+			if(heightAboveRoad > 500)
+				playerVehicle.onLongAir = true;
 		}
 		else
 		{
-			playerVehicle.onAir = true;
-			if(playerVehicle.verticalPosition - courseSegment.y > 500)
-				playerVehicle.onLongAir = true;
+			playerVehicle.verticalPosition = roadHeight;
+			if(playerVehicle.onLongAir)
+				sndJumpImpact->play();
+			playerVehicle.onAir = playerVehicle.onLongAir = false;
 		}
 	}
 	else
@@ -141,53 +176,346 @@ void Pseudo3DRaceState::handlePhysics(float delta)
 		playerVehicle.verticalPosition = courseSegment.y;
 	}
 
-	// verify for prop collision
-	if(courseSegment.propIndex != -1)
+	// verify for prop collision on every segment crossed during the step, so fast vehicles can't tunnel through props; the segment the
+	// car started in is only checked if it is still in it (if it left it, it was already checked and the car is moving away from it)
+	const float segmentLength = course.spec.roadSegmentLength / coursePositionFactor;
+	const int segmentCount = course.spec.lines.size(),
+			  firstSegmentIndex = static_cast<int>(floor(playerPreviousPosition / segmentLength)),
+			  lastSegmentIndex = static_cast<int>(floor(playerVehicle.position / segmentLength)),
+			  segmentIndexIncrement = (playerVehicle.position >= playerPreviousPosition? 1 : -1);
+
+	for(int index = (firstSegmentIndex == lastSegmentIndex? firstSegmentIndex : firstSegmentIndex + segmentIndexIncrement);
+			index != lastSegmentIndex + segmentIndexIncrement; index += segmentIndexIncrement)
 	{
-		const CourseSpec::Prop& prop = course.spec.props[courseSegment.propIndex];
-		if(prop.blocking)
+		const CourseSpec::Segment& crossedSegment = course.spec.lines[((index % segmentCount) + segmentCount) % segmentCount];
+		if(crossedSegment.propIndex == -1 or not course.spec.props[crossedSegment.propIndex].blocking)
+			continue;
+
+		const float pw = playerVehicle.spriteSpec.depictedVehicleWidth * playerVehicle.sprites.back()->scale.x * 7,
+					px = playerVehicle.horizontalPosition * coursePositionFactor - 0.5f*pw,
+					tx = crossedSegment.propX * coursePositionFactor * 10;  // FIXME fix this formula because it does not behave correctly for different sized props
+
+		if(not (px + pw < tx or px > tx))
 		{
-			const float pw = playerVehicle.spriteSpec.depictedVehicleWidth * playerVehicle.sprites.back()->scale.x * 7,
-						px = playerVehicle.horizontalPosition * coursePositionFactor - 0.5f*pw,
-						tx = courseSegment.propX * coursePositionFactor * 10;  // FIXME fix this formula because it does not behave correctly for different sized props
+			// revert progress up to just before the prop's segment (so the next step doesn't start in it), and push the car back a little bit
+			if(segmentIndexIncrement > 0)
+				playerVehicle.position = (index - PROP_COLLISION_CLEARANCE) * segmentLength;
+			else
+				playerVehicle.position = (index + 1 + PROP_COLLISION_CLEARANCE) * segmentLength;
+
+			playerVehicle.body.speed = -segmentIndexIncrement;
+			playerVehicle.isCrashing = true;
+			break;
+		}
+	}
 
-			cout << "pw=" << pw << " px=" << px << " tx=" << tx << endl;
-			if(not (px + pw < tx or px > tx))
-			{
-				cout << "collided with prop" << endl;
-				playerVehicle.position += (1.f - playerVehicle.body.speed) * delta;  // revert progress and pushes back the car a little bit
-				playerVehicle.body.speed = -1;
-				playerVehicle.isCrashing = true;
-			}
+	const float courseLength = course.spec.lines.size() * course.spec.roadSegmentLength / coursePositionFactor;
+
+	// review traffic LOD and advance far traffic, at a coarse interval (instead of every frame, so deterministic mode stays deterministic)
+	trafficLodTimeAccumulator += delta;
+	if(trafficLodTimeAccumulator >= TRAFFIC_LOD_UPDATE_INTERVAL)
+	{
+		updateTrafficSimulationLod(trafficLodTimeAccumulator, delta);
+		trafficLodTimeAccumulator = 0;
+	}
+
+	// update traffic
+	for(unsigned i = 0; i < trafficVehicles.size(); i++)
+	{
+		Pseudo3DVehicle& trafficVehicle = trafficVehicles[i];
+		switch(trafficSimulationLods[i])
+		{
+			case TRAFFIC_LOD_FULL:
+				trafficVehicle.body.rollingResistanceFactor = ROLLING_RESISTANCE_COEFFICIENT_DRY_ASPHALT;
+				trafficVehicle.body.tireFrictionFactor = TIRE_FRICTION_COEFFICIENT_DRY_ASPHALT;
+				trafficVehicle.body.updatePowertrain(delta);
+				trafficVehicle.position += trafficVehicle.body.speed*delta;  // update position
+				break;
+
+			case TRAFFIC_LOD_CRUISE:  // acceleration (sampled by updateTrafficSimulationLod()) is assumed constant in between reviews
+				trafficVehicle.body.speed += trafficVehicle.body.acceleration*delta;
+				trafficVehicle.position += trafficVehicle.body.speed*delta;
+				break;
+
+			case TRAFFIC_LOD_ANALYTICAL:  // advanced by updateTrafficSimulationLod()
+				break;
 		}
+
+		// keep traffic within the course length (rendering wraps positions around anyway)
+		trafficVehicle.position = getWrappedPosition(trafficVehicle.position, courseLength);
 	}
 
-	// verify for traffic collision
-	foreach(Pseudo3DVehicle&, trafficVehicle, vector<Pseudo3DVehicle>, trafficVehicles)
+	// update opponents
+	for(unsigned i = 0; i < opponentVehicles.size(); i++)
+	{
+		Pseudo3DVehicle& opponent = opponentVehicles[i];
+		handleOpponentDriving(opponent, opponentRacingLines[opponentRacingLineIndexes[i]], delta);
+		opponent.position = getWrappedPosition(opponent.position, courseLength);
+	}
+
+	// verify for vehicle collisions
+	handleVehicleCollisions();
+}
+
+void Pseudo3DRaceState::handleOpponentDriving(Pseudo3DVehicle& opponent, const RacingLine& racingLine, float delta)
+{
+	const unsigned segmentCount = course.spec.lines.size(),
+				   segmentIndex = static_cast<int>(opponent.position * coursePositionFactor / course.spec.roadSegmentLength) % segmentCount;
+	const SegmentPhysics& segmentCoefficients = segmentPhysics[segmentIndex];
+
+	// speed control (held still during the intro)
+	if(onSceneIntro)
+	{
+		opponent.body.engine.throttlePosition = 0;
+		opponent.body.brakePedalPosition = 1;
+	}
+	else
+		updateOpponentSpeedControl(opponent.body, segmentIndex, racingLine.targetSpeed, course.spec, coursePositionFactor);
+
+	opponent.body.rollingResistanceFactor = ROLLING_RESISTANCE_COEFFICIENT_DRY_ASPHALT;
+	opponent.body.tireFrictionFactor = TIRE_FRICTION_COEFFICIENT_DRY_ASPHALT;
+	opponent.body.setSlopeAngle(segmentCoefficients.slopeAngle, segmentCoefficients.slopeAngleSine);
+	opponent.body.updatePowertrain(delta);
+	opponent.position += opponent.body.speed*delta;
+
+	// steering control: strafe towards the racing line, within the same strafing speed limit as the player's
+	const float maxStrafeSpeed = MAXIMUM_STRAFE_SPEED_FACTOR * opponent.corneringStiffness;
+	opponent.strafeSpeed = std::max(-maxStrafeSpeed, std::min(maxStrafeSpeed, OPPONENT_STEERING_GAIN * (racingLine.lateralPosition[segmentIndex] - opponent.horizontalPosition)));
+	if(fabs(opponent.body.speed) < MINIMUM_SPEED_ALLOW_TURN)
+		opponent.strafeSpeed = 0;
+
+	opponent.horizontalPosition += opponent.strafeSpeed*delta;
+}
+
+void Pseudo3DRaceState::updateOpponentSpeedControl(Mechanics& body, unsigned segmentIndex, const vector<float>& targetSpeed, const Pseudo3DCourse::Spec& courseSpec, float coursePositionFactor)
+{
+	// aim for the target speed a bit ahead, with proportional throttle and brakes
+	const unsigned segmentCount = courseSpec.lines.size(),
+				   lookaheadSegmentCount = 1 + static_cast<unsigned>(fabs(body.speed) * OPPONENT_LOOKAHEAD_TIME * coursePositionFactor / courseSpec.roadSegmentLength);
+	const float speedError = targetSpeed[(segmentIndex + lookaheadSegmentCount) % segmentCount] - body.speed;
+	body.engine.throttlePosition = std::max(0.f, std::min(1.f, OPPONENT_THROTTLE_GAIN * speedError));
+	body.brakePedalPosition = std::max(0.f, std::min(1.f, -OPPONENT_BRAKE_GAIN * speedError));
+}
+
+RacingLine Pseudo3DRaceState::computeRacingLine(const Pseudo3DVehicle& vehicle)
+{
+	Mechanics body(vehicle.body);
+	body.rollingResistanceFactor = ROLLING_RESISTANCE_COEFFICIENT_DRY_ASPHALT;
+	body.tireFrictionFactor = TIRE_FRICTION_COEFFICIENT_DRY_ASPHALT;
+	return RacingLine::compute(course.spec, coursePositionFactor, body, MAXIMUM_STRAFE_SPEED_FACTOR * vehicle.corneringStiffness);
+}
+
+void Pseudo3DRaceState::updateTrafficSimulationLod(float elapsed, float delta)
+{
+	const float courseLength = course.spec.lines.size() * course.spec.roadSegmentLength / coursePositionFactor,
+				playerPosition = getWrappedPosition(playerVehicle.position, courseLength),
+				fullLodDistance = course.drawDistance * course.spec.roadSegmentLength / coursePositionFactor,  // visible vehicles get full physics
+				cruiseLodDistance = 2 * fullLodDistance;
+
+	for(unsigned i = 0; i < trafficVehicles.size(); i++)
 	{
-		trafficVehicle.body.rollingResistanceFactor = ROLLING_RESISTANCE_COEFFICIENT_DRY_ASPHALT;
-		trafficVehicle.body.tireFrictionFactor = TIRE_FRICTION_COEFFICIENT_DRY_ASPHALT;
-		trafficVehicle.body.updatePowertrain(delta);
-		trafficVehicle.position += trafficVehicle.body.speed*delta;  // update position
+		Pseudo3DVehicle& trafficVehicle = trafficVehicles[i];
+		TrafficSimulationLod& lod = trafficSimulationLods[i];
 
-		const unsigned trafficVehicleCourseSegmentIndex = static_cast<int>(trafficVehicle.position * coursePositionFactor / course.spec.roadSegmentLength) % course.spec.lines.size();
-		if(trafficVehicleCourseSegmentIndex == courseSegmentIndex)  // if on the same segment, check for collision
+		if(lod != TRAFFIC_LOD_FULL)
 		{
-			const float pw = playerVehicle.spriteSpec.depictedVehicleWidth * playerVehicle.sprites.back()->scale.x * 7,
-						px = playerVehicle.horizontalPosition * coursePositionFactor - 0.5f*pw,
-						tw = trafficVehicle.spriteSpec.depictedVehicleWidth * trafficVehicle.sprites.back()->scale.x * 7,
-						tx = trafficVehicle.horizontalPosition * coursePositionFactor - 0.5f*tw;
+			Mechanics& body = trafficVehicle.body;
 
-			if(not (px + pw < tx or px > tx + tw))
+			// far traffic is advanced by the whole interval at once, assuming constant acceleration
+			if(lod == TRAFFIC_LOD_ANALYTICAL)
 			{
-				// slow player's vehicle down using collision formula (but not applying to traffic vehicle, though)
-				playerVehicle.body.speed = (COLLISION_RESTITUTION_COEFFICIENT * trafficVehicle.body.mass * (trafficVehicle.body.speed - playerVehicle.body.speed)
-											+ playerVehicle.body.mass * playerVehicle.body.speed + trafficVehicle.body.mass * trafficVehicle.body.speed)
-													/(playerVehicle.body.mass + trafficVehicle.body.mass);
-				playerVehicle.isCrashing = true;
+				trafficVehicle.position = getWrappedPosition(trafficVehicle.position + (body.speed + 0.5f * body.acceleration * elapsed) * elapsed, courseLength);
+				body.speed += body.acceleration * elapsed;
 			}
+
+			// sample the acceleration (and update rpm and gear) with a single powertrain update, without integrating speed
+			const float speed = body.speed;
+			body.rollingResistanceFactor = ROLLING_RESISTANCE_COEFFICIENT_DRY_ASPHALT;
+			body.tireFrictionFactor = TIRE_FRICTION_COEFFICIENT_DRY_ASPHALT;
+			body.automaticShiftingLastTime += elapsed - delta;  // account for the whole interval
+			body.updatePowertrain(delta);
+			body.speed = speed;
+		}
+
+		// distance to the player, either ahead or behind
+		float distance = fabs(trafficVehicle.position - playerPosition);
+		if(distance > 0.5f * courseLength)
+			distance = courseLength - distance;
+
+		// demotion requires a bit more distance than promotion, so vehicles around the thresholds don't keep switching
+		if(distance < fullLodDistance)
+			lod = TRAFFIC_LOD_FULL;
+
+		else if(lod == TRAFFIC_LOD_FULL)
+		{
+			if(distance > TRAFFIC_LOD_HYSTERESIS_FACTOR * fullLodDistance)
+				lod = TRAFFIC_LOD_CRUISE;
 		}
+		else if(distance > TRAFFIC_LOD_HYSTERESIS_FACTOR * cruiseLodDistance)
+			lod = TRAFFIC_LOD_ANALYTICAL;
+
+		else if(distance < cruiseLodDistance)
+			lod = TRAFFIC_LOD_CRUISE;
+	}
+}
+
+// returns the given distance (difference between positions) wrapped within [-courseLength/2, courseLength/2), i.e. the shortest way around
+static inline float getWrappedDistance(float distance, float courseLength)
+{
+	if(distance >= 0.5f * courseLength) return distance - courseLength;
+	if(distance < -0.5f * courseLength) return distance + courseLength;
+	return distance;
+}
+
+void Pseudo3DRaceState::handleVehicleCollisions()
+{
+	const float courseLength = course.spec.lines.size() * course.spec.roadSegmentLength / coursePositionFactor,
+				collisionLength = course.spec.roadSegmentLength / coursePositionFactor;  // longitudinal extent of a vehicle, for collision purposes
+
+	// compute the interval swept by each vehicle during the step, extended by the vehicle's own extent
+	for(unsigned i = 0; i < vehicleSweeps.size(); i++)
+	{
+		VehicleSweep& sweep = vehicleSweeps[i];
+		const float position = getWrappedPosition(sweep.vehicle->position, courseLength);
+		sweep.displacement = getWrappedDistance(sweep.vehicle->position - sweep.previousPosition, courseLength);
+		sweep.start = sweep.displacement > 0? getWrappedPosition(position - sweep.displacement, courseLength) : position;
+		sweep.length = fabs(sweep.displacement) + collisionLength;
+	}
+
+	// keep intervals sorted by start; since vehicles move very little between steps, the list is nearly sorted and insertion sort is quick
+	for(unsigned i = 1; i < vehicleSweeps.size(); i++)
+	{
+		const VehicleSweep sweep = vehicleSweeps[i];
+		unsigned j = i;
+		for(; j > 0 and vehicleSweeps[j-1].start > sweep.start; j--)
+			vehicleSweeps[j] = vehicleSweeps[j-1];
+		vehicleSweeps[j] = sweep;
+	}
+
+	// sweep and prune: check each interval only against the ones starting within it (wrapping around the course end)
+	const unsigned vehicleCount = vehicleSweeps.size();
+	for(unsigned i = 0; i < vehicleCount; i++)
+	{
+		const VehicleSweep& sweep = vehicleSweeps[i];
+		for(unsigned k = 1; k < vehicleCount; k++)
+		{
+			const VehicleSweep& otherSweep = vehicleSweeps[(i+k) % vehicleCount];
+			float distance = otherSweep.start - sweep.start;
+			if(distance < 0)
+				distance += courseLength;
+
+			if(distance >= sweep.length)
+				break;
+
+			handleVehicleCollision(sweep, otherSweep);
+		}
+	}
+}
+
+void Pseudo3DRaceState::handleVehicleCollision(const VehicleSweep& sweep, const VehicleSweep& otherSweep)
+{
+	const float courseLength = course.spec.lines.size() * course.spec.roadSegmentLength / coursePositionFactor,
+				collisionLength = course.spec.roadSegmentLength / coursePositionFactor;
+
+	// longitudinal distance between the vehicles at the end and at the start of the step; they collide if it got within the collision length
+	const float distance = getWrappedDistance(otherSweep.vehicle->position - sweep.vehicle->position, courseLength),
+				previousDistance = distance - (otherSweep.displacement - sweep.displacement);
+
+	if(std::min(distance, previousDistance) >= collisionLength or std::max(distance, previousDistance) <= -collisionLength)
+		return;
+
+	const bool isOtherAhead = previousDistance > 0 or (previousDistance == 0 and distance >= 0);
+	Pseudo3DVehicle& rearVehicle = *(isOtherAhead? sweep.vehicle : otherSweep.vehicle),
+				   & frontVehicle = *(isOtherAhead? otherSweep.vehicle : sweep.vehicle);
+	const float frontDistance = isOtherAhead? distance : -distance;  // negative if the rear vehicle passed through the front one
+
+	const float rw = rearVehicle.spriteSpec.depictedVehicleWidth * rearVehicle.sprites.back()->scale.x * 7,
+				rx = rearVehicle.horizontalPosition * coursePositionFactor - 0.5f*rw,
+				fw = frontVehicle.spriteSpec.depictedVehicleWidth * frontVehicle.sprites.back()->scale.x * 7,
+				fx = frontVehicle.horizontalPosition * coursePositionFactor - 0.5f*fw;
+
+	if(rx + rw < fx or rx > fx + fw)
+		return;
+
+	Mechanics& rearBody = rearVehicle.body, &frontBody = frontVehicle.body;
+	const float totalMass = rearBody.mass + frontBody.mass,
+				totalMomentum = rearBody.mass * rearBody.speed + frontBody.mass * frontBody.speed;
+
+	if(&rearVehicle == &playerVehicle or &frontVehicle == &playerVehicle)
+	{
+		Mechanics& otherBody = (&rearVehicle == &playerVehicle? frontBody : rearBody);
+
+		// slow player's vehicle down using collision formula (but not applying to the other vehicle, though)
+		playerVehicle.body.speed = (COLLISION_RESTITUTION_COEFFICIENT * otherBody.mass * (otherBody.speed - playerVehicle.body.speed) + totalMomentum)/totalMass;
+		playerVehicle.isCrashing = true;
 	}
+	else if(rearBody.speed > frontBody.speed)  // other vehicles only collide if closing in, otherwise they are already moving apart
+	{
+		const float rearSpeed = rearBody.speed;
+		rearBody.speed = (COLLISION_RESTITUTION_COEFFICIENT * frontBody.mass * (frontBody.speed - rearSpeed) + totalMomentum)/totalMass;
+		frontBody.speed = (COLLISION_RESTITUTION_COEFFICIENT * rearBody.mass * (rearSpeed - frontBody.speed) + totalMomentum)/totalMass;
+		rearVehicle.isCrashing = frontVehicle.isCrashing = true;  // only used for sound effects
+	}
+	else return;
+
+	// if the rear vehicle passed through the front one during the step, move it back to where they met
+	if(frontDistance < 0)
+		rearVehicle.position += frontDistance;
+}
+
+void Pseudo3DRaceState::computeSegmentPhysics()
+{
+	const unsigned segmentCount = course.spec.lines.size();
+	segmentPhysics.resize(segmentCount);
+	for(unsigned i = 0; i < segmentCount; i++)
+	{
+		SegmentPhysics& coefficients = segmentPhysics[i];
+		coefficients.slopeAngle = course.spec.getSlopeAngle(i);
+		coefficients.slopeAngleSine = course.spec.getSlopeAngleSine(i);
+		coefficients.curvePullFactor = course.spec.getCurvePullFactor(i);
+	}
+}
+
+// FNV-1a hash, accumulated over the bytes of the given value
+template <typename T>
+static unsigned hashValue(unsigned hash, const T& value)
+{
+	unsigned char bytes[sizeof(T)];
+	memcpy(bytes, &value, sizeof(T));
+	for(unsigned i = 0; i < sizeof(T); i++)
+		hash = (hash ^ bytes[i]) * 16777619u;
+	return hash;
+}
+
+static unsigned hashVehicleState(unsigned hash, const Pseudo3DVehicle& vehicle)
+{
+	const Mechanics& body = vehicle.body;
+	hash = hashValue(hash, vehicle.position);
+	hash = hashValue(hash, vehicle.horizontalPosition);
+	hash = hashValue(hash, vehicle.verticalPosition);
+	hash = hashValue(hash, vehicle.strafeSpeed);
+	hash = hashValue(hash, vehicle.verticalSpeed);
+	hash = hashValue(hash, vehicle.pseudoAngle);
+	hash = hashValue(hash, vehicle.virtualOrientation);
+	hash = hashValue(hash, body.speed);
+	hash = hashValue(hash, body.acceleration);
+	hash = hashValue(hash, body.wheelAngularSpeed);
+	hash = hashValue(hash, body.slipRatio);
+	hash = hashValue(hash, body.differentialSlipRatio);
+	hash = hashValue(hash, body.automaticShiftingLastTime);
+	hash = hashValue(hash, body.engine.rpm);
+	hash = hashValue(hash, body.engine.gear);
+	return hash;
+}
+
+unsigned Pseudo3DRaceState::computePhysicsStateHash() const
+{
+	unsigned hash = hashVehicleState(2166136261u, playerVehicle);
+	for(unsigned i = 0; i < trafficVehicles.size(); i++)
+		hash = hashVehicleState(hash, trafficVehicles[i]);
+	for(unsigned i = 0; i < opponentVehicles.size(); i++)
+		hash = hashVehicleState(hash, opponentVehicles[i]);
+	return hash;
 }
 
 void Pseudo3DRaceState::shiftGear(int gear)
@@ -196,7 +524,7 @@ void Pseudo3DRaceState::shiftGear(int gear)
 	playerVehicle.body.shiftGear(gear);
 }
 
-Pseudo3DRaceState::SurfaceType Pseudo3DRaceState::getCurrentSurfaceType()
+Pseudo3DRaceState::SurfaceType Pseudo3DRaceState::computeCurrentSurfaceType()
 {
 	if(fabs(playerVehicle.horizontalPosition * coursePositionFactor) > 1.2*course.spec.roadWidth)
 		return SURFACE_TYPE_GRASS;
@@ -206,7 +534,7 @@ Pseudo3DRaceState::SurfaceType Pseudo3DRaceState::getCurrentSurfaceType()
 
 float Pseudo3DRaceState::getTireKineticFrictionCoefficient()
 {
-	switch(getCurrentSurfaceType())
+	switch(playerSurfaceType)
 	{
 		default:
 		case SURFACE_TYPE_DRY_ASPHALT: return TIRE_FRICTION_COEFFICIENT_DRY_ASPHALT;
@@ -216,7 +544,7 @@ float Pseudo3DRaceState::getTireKineticFrictionCoefficient()
 
 float Pseudo3DRaceState::getTireRollingResistanceCoefficient()
 {
-	switch(getCurrentSurfaceType())
+	switch(playerSurfaceType)
 	{
 		default:
 		case SURFACE_TYPE_DRY_ASPHALT: return ROLLING_RESISTANCE_COEFFICIENT_DRY_ASPHALT;
@@ -13,9 +13,9 @@
 
 namespace RaceOnlyArgs
 {
-	extern TCLAP::SwitchArg randomCourse, debugMode, imperialUnit;
+	extern TCLAP::SwitchArg randomCourse, debugMode, imperialUnit, deterministicPhysics;
 	extern TCLAP::ValueArg<int> vehicleAlternateSpriteIndex;
-	extern TCLAP::ValueArg<unsigned> raceType, lapCount, courseIndex, vehicleIndex, simulationType, hudType;
+	extern TCLAP::ValueArg<unsigned> raceType, lapCount, courseIndex, vehicleIndex, simulationType, hudType, randomSeed, opponentCount;
 }
 
 #endif /* RACE_ONLY_ARGS_HPP_ */
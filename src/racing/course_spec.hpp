@@ -10,6 +10,7 @@
 #include <ciso646>
 
 #include <vector>
+#include <cmath>
 
 /** a object that describes a course physically and logically (but not graphically) */
 struct CourseSpec
@@ -49,6 +50,38 @@ struct CourseSpec
 	CourseSpec(float segmentLength, float roadWidth)
 	: lines(), roadSegmentLength(segmentLength), roadWidth(roadWidth), props()
 	{}
+
+	/** returns the height difference between the previous segment and the given one (courses loop, so the first segment follows the last one) */
+	inline float getSlopeRise(unsigned index) const
+	{
+		return lines[index].y - lines[index > 0? index-1 : lines.size()-1].y;
+	}
+
+	/** returns the slope angle (in radians) between the previous segment and the given one */
+	inline float getSlopeAngle(unsigned index) const
+	{
+		return atan2(getSlopeRise(index), roadSegmentLength);
+	}
+
+	/** returns the sine of the slope angle between the previous segment and the given one */
+	inline float getSlopeAngleSine(unsigned index) const
+	{
+		const float rise = getSlopeRise(index), run = roadSegmentLength;
+		return rise / sqrt(rise*rise + run*run);  // same as sin(atan2(rise, run)), but only with correctly rounded operations, thus reproducible
+	}
+
+	/** returns the curve pull factor of the given segment: the lateral speed with which a vehicle on it is pulled to the outside of the curve, per squared speed */
+	inline float getCurvePullFactor(unsigned index) const
+	{
+//		const float curvatureFactor = 2 * sin(0.5 * segment.curve);  // correct formula according to theory, assuming 'segment.curve' is the degree of curvature, in radians. however it does not behave nicely...
+//		const float curvatureFactor = 2 * sin(atan(0.5 * segment.curve));
+//		const float curvatureFactor = 2 * sin(atan(0.4 * pow2(segment.curve))) * sgn(segment.curve);
+//		const float curvatureFactor = sqrt(2 * segment.curve) * atan(0.5 * segment.curve);
+//		const float curvatureFactor = sqrt(2 * fabs(segment.curve)) * atan(0.25 * pow2(segment.curve)) * sgn(segment.curve);
+//		const float curvatureFactor = 1.25 * segment.curve - atan(segment.curve);
+		const float curvatureFactor = 1.25 * lines[index].curve;
+		return curvatureFactor / roadSegmentLength;
+	}
 };
 
 #endif /* RACING_COURSE_SPEC_HPP_ */
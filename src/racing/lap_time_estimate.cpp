@@ -0,0 +1,60 @@
+/*
+ * lap_time_estimate.cpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#include "lap_time_estimate.hpp"
+
+#include "racing_line.hpp"
+
+#include <cmath>
+#include <cfloat>
+
+using std::vector;
+
+LapTimeEstimate LapTimeEstimate::estimate(const CourseSpec& course, float positionFactor, const Mechanics& body, float maximumLateralSpeed)
+{
+	const unsigned segmentCount = course.lines.size();
+	const float segmentLength = course.roadSegmentLength / positionFactor;
+
+	LapTimeEstimate estimate;
+	if(segmentCount == 0)
+		return estimate;
+
+	estimate.speed.resize(segmentCount);
+	vector<float> slopeAngleSine(segmentCount);
+	for(unsigned i = 0; i < segmentCount; i++)
+	{
+		// the highest speed on which the curve pull can still be countered (unlike racing lines, no margin is left)
+		const float curvePullFactor = fabs(course.getCurvePullFactor(i));
+		estimate.speed[i] = curvePullFactor > 0? sqrt(maximumLateralSpeed / curvePullFactor) : FLT_MAX;
+		slopeAngleSine[i] = course.getSlopeAngleSine(i);
+	}
+
+	RacingLine::computeSpeedProfile(estimate.speed, slopeAngleSine, segmentLength, body);
+
+	estimate.topSpeed = 0;
+	estimate.minimumSpeed = FLT_MAX;
+	for(unsigned i = 0; i < segmentCount; i++)
+	{
+		if(estimate.speed[i] > estimate.topSpeed) estimate.topSpeed = estimate.speed[i];
+		if(estimate.speed[i] < estimate.minimumSpeed) estimate.minimumSpeed = estimate.speed[i];
+	}
+
+	// assuming constant acceleration within each segment, the time spent on it is its length over the mean of its entry and exit speeds
+	double lapTime = 0;
+	for(unsigned i = 0; i < segmentCount; i++)
+	{
+		const float entrySpeed = estimate.speed[i], exitSpeed = estimate.speed[(i + 1) % segmentCount];
+		if(entrySpeed + exitSpeed <= 0)
+			return estimate;  // stalled, the lap can't be completed
+
+		lapTime += 2 * segmentLength / (entrySpeed + exitSpeed);
+	}
+
+	estimate.lapTime = lapTime;
+	estimate.averageSpeed = segmentCount * segmentLength / lapTime;
+	return estimate;
+}
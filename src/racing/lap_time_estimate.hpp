@@ -0,0 +1,42 @@
+/*
+ * lap_time_estimate.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef RACING_LAP_TIME_ESTIMATE_HPP_
+#define RACING_LAP_TIME_ESTIMATE_HPP_
+#include <ciso646>
+
+#include "course_spec.hpp"
+
+#include "automotive/mechanics.hpp"
+
+#include <vector>
+
+/** A quasi-steady-state estimate of a vehicle's lap on a course: instead of simulating the lap step by step, the speed on each segment
+ *  is computed analytically from the vehicle's limits (cornering, drive force, air drag, downforce, rolling resistance and tire friction),
+ *  which is orders of magnitude faster and thus suitable for comparing many vehicles and courses at once. */
+struct LapTimeEstimate
+{
+	/** The speed trace: the estimated speed on each segment, in m/s. */
+	std::vector<float> speed;
+
+	/** The estimated lap time, in seconds, or a negative value if the vehicle can't complete the lap (i.e. stalls on a slope). */
+	float lapTime;
+
+	/** The average, highest and lowest speeds over the lap, in m/s. */
+	float averageSpeed, topSpeed, minimumSpeed;
+
+	LapTimeEstimate() : speed(), lapTime(-1), averageSpeed(0), topSpeed(0), minimumSpeed(0) {}
+
+	/** Estimates a flying lap (i.e. entering the lap at speed) of the given vehicle over the given course. On each segment, the speed is
+	 *  limited by how much of the curve pull can be countered with the given maximum lateral speed, and then by how much the vehicle
+	 *  can accelerate and brake between segments (see RacingLine::computeSpeedProfile). The body's tire friction and rolling resistance
+	 *  factors must already be set (according to the road surface). 'positionFactor' is the ratio between course units and vehicle
+	 *  positions (as in Pseudo3DCourse::lengthScale). */
+	static LapTimeEstimate estimate(const CourseSpec& course, float positionFactor, const Mechanics& body, float maximumLateralSpeed);
+};
+
+#endif /* RACING_LAP_TIME_ESTIMATE_HPP_ */
@@ -0,0 +1,137 @@
+/*
+ * racing_line.cpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#include "racing_line.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using std::vector;
+
+static const float
+	CORNERING_MARGIN = 0.8,  // fraction of the maximum lateral speed that is used to counter the curve pull
+	LATERAL_OFFSET_FACTOR = 0.6,  // how far from the center the racing line can go, as a fraction of the road width
+	LATERAL_OFFSET_FULL_CURVE = 0.5,  // segments whose curve is at least this much get the full lateral offset
+	LATERAL_SMOOTHING_DISTANCE = 60,  // the distance (in meters) over which the lateral position is smoothed, ahead and behind
+	TOP_SPEED_SEARCH_STEP = 0.5,  // in m/s
+	TOP_SPEED_SEARCH_LIMIT = 200;  // in m/s
+
+// replaces each value by the average of the values within the given radius (in indexes), treating the values as a loop
+static void smoothCircularly(vector<float>& values, unsigned radius)
+{
+	const unsigned n = values.size();
+	if(n == 0 or radius == 0)
+		return;
+
+	if(2*radius + 1 > n)
+		radius = (n - 1)/2;
+
+	vector<double> prefixSum(n+1, 0);
+	for(unsigned i = 0; i < n; i++)
+		prefixSum[i+1] = prefixSum[i] + values[i];
+
+	// the sum of values[begin, end), with begin and end within [0, n]
+	#define RANGE_SUM(begin, end) (prefixSum[end] - prefixSum[begin])
+
+	for(unsigned i = 0; i < n; i++)
+	{
+		double sum;
+		if(i >= radius and i + radius < n)
+			sum = RANGE_SUM(i - radius, i + radius + 1);
+		else if(i < radius)  // wraps around the beginning
+			sum = RANGE_SUM(0, i + radius + 1) + RANGE_SUM(n - (radius - i), n);
+		else  // wraps around the end
+			sum = RANGE_SUM(i - radius, n) + RANGE_SUM(0, i + radius + 1 - n);
+
+		values[i] = sum / (2*radius + 1);
+	}
+
+	#undef RANGE_SUM
+}
+
+RacingLine RacingLine::compute(const CourseSpec& course, float positionFactor, const Mechanics& body, float maximumLateralSpeed)
+{
+	const unsigned segmentCount = course.lines.size();
+	const float segmentLength = course.roadSegmentLength / positionFactor,
+				maximumLateralOffset = LATERAL_OFFSET_FACTOR * course.roadWidth / positionFactor;
+
+	RacingLine line;
+	line.lateralPosition.resize(segmentCount);
+	line.targetSpeed.resize(segmentCount);
+	vector<float> slopeAngleSine(segmentCount);
+
+	for(unsigned i = 0; i < segmentCount; i++)
+	{
+		const float curve = course.lines[i].curve, curvePullFactor = fabs(course.getCurvePullFactor(i));
+
+		// cut to the inside of curves (curve pull pushes vehicles to the outside, towards negative positions on positive curves)
+		line.lateralPosition[i] = maximumLateralOffset * std::max(-1.f, std::min(1.f, curve / LATERAL_OFFSET_FULL_CURVE));
+
+		// the highest speed on which the curve pull can still be countered
+		line.targetSpeed[i] = curvePullFactor > 0? sqrt(CORNERING_MARGIN * maximumLateralSpeed / curvePullFactor) : TOP_SPEED_SEARCH_LIMIT;
+
+		slopeAngleSine[i] = course.getSlopeAngleSine(i);
+	}
+
+	// smooth twice, so the line approaches curves gradually (outside, then inside, then outside again)
+	const unsigned smoothingRadius = LATERAL_SMOOTHING_DISTANCE / segmentLength;
+	smoothCircularly(line.lateralPosition, smoothingRadius);
+	smoothCircularly(line.lateralPosition, smoothingRadius);
+
+	computeSpeedProfile(line.targetSpeed, slopeAngleSine, segmentLength, body);
+	return line;
+}
+
+void RacingLine::computeSpeedProfile(vector<float>& speedLimit, const vector<float>& slopeAngleSine, float segmentLength, const Mechanics& body)
+{
+	const unsigned segmentCount = speedLimit.size();
+	if(segmentCount == 0)
+		return;
+
+	const float weight = body.mass * Mechanics::GRAVITY_ACCELERATION,
+				rollingResistanceForce = body.rollingResistanceFactor * weight,
+				brakingForce = body.tireFrictionFactor * weight;  // same as with full brakes on Mechanics
+
+	// no segment can be faster than the vehicle's top speed on flat ground
+	float topSpeed = 0;
+	while(topSpeed < TOP_SPEED_SEARCH_LIMIT and body.getMaximumDriveForce(topSpeed) > body.getAirDragForce(topSpeed) + rollingResistanceForce)
+		topSpeed += TOP_SPEED_SEARCH_STEP;
+
+	unsigned slowestSegmentIndex = 0;
+	for(unsigned i = 0; i < segmentCount; i++)
+	{
+		speedLimit[i] = std::min(speedLimit[i], topSpeed);
+		if(speedLimit[i] < speedLimit[slowestSegmentIndex])
+			slowestSegmentIndex = i;
+	}
+
+	// both passes start from the slowest segment, whose speed can't be limited any further, so a single lap is enough
+
+	// forward pass: limit speed by how much the vehicle can accelerate from the previous segment
+	for(unsigned k = 1; k < segmentCount; k++)
+	{
+		const unsigned i = (slowestSegmentIndex + k) % segmentCount, previous = (i + segmentCount - 1) % segmentCount;
+		const float speed = speedLimit[previous],
+					netForce = body.getMaximumDriveForce(speed) - body.getAirDragForce(speed) - rollingResistanceForce - weight * slopeAngleSine[i],
+					reachableSpeed = sqrt(std::max(0.f, speed*speed + 2 * (netForce / body.mass) * segmentLength));
+
+		if(reachableSpeed < speedLimit[i])
+			speedLimit[i] = reachableSpeed;
+	}
+
+	// backward pass: limit speed by how much the vehicle can decelerate until the next segment
+	for(unsigned k = 1; k < segmentCount; k++)
+	{
+		const unsigned i = (slowestSegmentIndex + segmentCount - k) % segmentCount, next = (i + 1) % segmentCount;
+		const float speed = speedLimit[next],
+					retardingForce = brakingForce + body.getAirDragForce(speed) + rollingResistanceForce + weight * slopeAngleSine[next],
+					reachableSpeed = sqrt(std::max(0.f, speed*speed + 2 * (retardingForce / body.mass) * segmentLength));
+
+		if(reachableSpeed < speedLimit[i])
+			speedLimit[i] = reachableSpeed;
+	}
+}
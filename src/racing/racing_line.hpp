@@ -0,0 +1,41 @@
+/*
+ * racing_line.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef RACING_RACING_LINE_HPP_
+#define RACING_RACING_LINE_HPP_
+#include <ciso646>
+
+#include "course_spec.hpp"
+
+#include "automotive/mechanics.hpp"
+
+#include <vector>
+
+/** A racing line over a course, for a given vehicle: the lateral position to hold and the target speed on each course segment.
+ *  It is meant to be computed once (when the course is loaded), so that AI drivers only need a table lookup per step. */
+struct RacingLine
+{
+	/** The lateral (horizontal) position to hold on each segment, in the same units as the vehicles' horizontal positions. */
+	std::vector<float> lateralPosition;
+
+	/** The target speed on each segment, in m/s. */
+	std::vector<float> targetSpeed;
+
+	/** Computes the racing line of the given vehicle over the given course. The lateral position cuts to the inside of curves, while
+	 *  the target speed is the highest one that the vehicle can hold through each curve (given the maximum lateral speed it can use to
+	 *  counter the curve pull), and then reduced by braking and power limits (given the body's tire friction and engine), on slopes
+	 *  as well. 'positionFactor' is the ratio between course units and vehicle positions (as in Pseudo3DCourse::lengthScale). */
+	static RacingLine compute(const CourseSpec& course, float positionFactor, const Mechanics& body, float maximumLateralSpeed);
+
+	/** Computes the speed profile of the given vehicle over a course, given the speed limit on each segment, the sine of the slope angle
+	 *  of each segment and the segment length (in meters). Starting from the given speed limits, a forward pass limits accelerations by
+	 *  the vehicle's drive force and a backward pass limits decelerations by its braking force (both accounting for air drag, rolling
+	 *  resistance and slope pull). The course is assumed to loop. The result is stored on 'speedLimit' itself. */
+	static void computeSpeedProfile(std::vector<float>& speedLimit, const std::vector<float>& slopeAngleSine, float segmentLength, const Mechanics& body);
+};
+
+#endif /* RACING_RACING_LINE_HPP_ */
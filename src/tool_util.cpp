@@ -0,0 +1,121 @@
+/*
+ * tool_util.cpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#include "tool_util.hpp"
+
+#include "futil/language.hpp"
+
+#include <sstream>
+#include <vector>
+
+#include <pthread.h>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <unistd.h>
+#endif
+
+using std::string;
+
+const float MPS_TO_KPH = 3.6;
+
+const char* const SIMULATION_TYPE_NAMES[Mechanics::SIMULATION_TYPE_COUNT] = { "slipless", "wheel_load_cap", "pacejka" };
+
+string formatFigure(float value, const string& placeholder)
+{
+	if(value < 0)
+		return placeholder;
+
+	std::ostringstream stream;
+	stream.setf(std::ios::fixed);
+	stream.precision(2);
+	stream << value;
+	return stream.str();
+}
+
+string escapeCsv(const string& str)
+{
+	string escaped = "\"";
+	for(unsigned i = 0; i < str.size(); i++)
+		escaped += (str[i] == '"'? "\"\"" : string(1, str[i]));
+	return escaped + "\"";
+}
+
+string escapeJson(const string& str)
+{
+	string escaped = "\"";
+	for(unsigned i = 0; i < str.size(); i++)
+		if(str[i] == '"' or str[i] == '\\') escaped += string("\\") + str[i];
+		else if(str[i] == '\n') escaped += "\\n";
+		else if((unsigned char) str[i] >= 0x20) escaped += str[i];
+	return escaped + "\"";
+}
+
+unsigned getProcessorCount()
+{
+	#ifdef _WIN32
+		SYSTEM_INFO systemInfo;
+		GetSystemInfo(&systemInfo);
+		return systemInfo.dwNumberOfProcessors > 0? systemInfo.dwNumberOfProcessors : 1;
+	#else
+		const long processorCount = sysconf(_SC_NPROCESSORS_ONLN);
+		return processorCount > 0? processorCount : 1;
+	#endif
+}
+
+namespace  // anonymous
+{
+	// shared between worker threads; each worker repeatedly picks the next job not yet taken
+	struct ParallelJobQueue
+	{
+		void (*job)(void*, unsigned);
+		void* context;
+		unsigned jobCount, nextJobIndex;
+		pthread_mutex_t mutex;
+
+		ParallelJobQueue(void (*job)(void*, unsigned), void* context, unsigned jobCount)
+		: job(job), context(context), jobCount(jobCount), nextJobIndex(0) { pthread_mutex_init(&mutex, null); }
+
+		~ParallelJobQueue() { pthread_mutex_destroy(&mutex); }
+	};
+}
+
+static void* parallelJobWorker(void* arg)
+{
+	ParallelJobQueue& queue = *static_cast<ParallelJobQueue*>(arg);
+	while(true)
+	{
+		pthread_mutex_lock(&queue.mutex);
+		const unsigned jobIndex = queue.nextJobIndex++;
+		pthread_mutex_unlock(&queue.mutex);
+
+		if(jobIndex >= queue.jobCount)
+			return null;
+
+		queue.job(queue.context, jobIndex);
+	}
+}
+
+void runParallelJobs(void (*job)(void*, unsigned), void* context, unsigned jobCount, unsigned threadCount)
+{
+	if(threadCount > jobCount)
+		threadCount = jobCount;
+
+	ParallelJobQueue queue(job, context, jobCount);
+	std::vector<pthread_t> threads(threadCount > 1? threadCount : 0);
+	unsigned startedThreadCount = 0;
+	for(unsigned i = 0; i < threads.size(); i++)
+		if(pthread_create(&threads[startedThreadCount], null, parallelJobWorker, &queue) == 0)
+			startedThreadCount++;
+
+	if(startedThreadCount == 0)  // a single thread, or could not start any thread, do it in this one
+		parallelJobWorker(&queue);
+
+	for(unsigned i = 0; i < startedThreadCount; i++)
+		pthread_join(threads[i], null);
+}
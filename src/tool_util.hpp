@@ -0,0 +1,41 @@
+/*
+ * tool_util.hpp
+ *
+ *  Created on: 19 de out de 2026
+ *      Author: carlosfaruolo
+ */
+
+#ifndef TOOL_UTIL_HPP_
+#define TOOL_UTIL_HPP_
+#include <ciso646>
+
+#include "automotive/mechanics.hpp"
+
+#include <string>
+
+// Helpers shared by the offline (headless) tools (performance analysis, lap time estimation, gear ratio optimization and physics regression).
+
+// m/s to km/h conversion factor
+extern const float MPS_TO_KPH;
+
+// the name of each simulation type, as written by the tools
+extern const char* const SIMULATION_TYPE_NAMES[Mechanics::SIMULATION_TYPE_COUNT];
+
+/** Formats the given value with 2 decimal places, or returns the given placeholder if the value is negative (not reached). */
+std::string formatFigure(float value, const std::string& placeholder);
+
+/** Returns the given string as a quoted CSV field. */
+std::string escapeCsv(const std::string& str);
+
+/** Returns the given string as a quoted JSON string. */
+std::string escapeJson(const std::string& str);
+
+/** Returns the number of processors available to this process (at least 1). */
+unsigned getProcessorCount();
+
+/** Calls job(context, index) for each index in [0, jobCount), spread over the given number of threads, and returns when all are done.
+ *  Each thread repeatedly picks the next index not yet taken, so jobs must only share read-only data (besides their own results). If
+ *  threads can't be started, all jobs are run in the calling thread instead. */
+void runParallelJobs(void (*job)(void* context, unsigned index), void* context, unsigned jobCount, unsigned threadCount);
+
+#endif /* TOOL_UTIL_HPP_ */
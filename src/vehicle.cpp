@@ -7,6 +7,8 @@
 
 #include "vehicle.hpp"
 
+#include "gfx/image_cache.hpp"
+
 #include "futil/string_actions.hpp"
 
 #include <stdexcept>
@@ -14,11 +16,15 @@
 #include <cmath>
 
 using std::string;
+using std::vector;
 using fgeal::Vector2D;
 using fgeal::Point;
 using fgeal::Image;
 using fgeal::Sprite;
 
+// how many prescaled levels the sprites get, at most, and the smallest frame size (in pixels) of a level
+static const unsigned SPRITE_MIP_LEVEL_COUNT = 3, MINIMUM_MIP_LEVEL_FRAME_SIZE = 8;
+
 Pseudo3DVehicle::Pseudo3DVehicle()
 : body(Engine(), Mechanics::TYPE_OTHER),
   position(), horizontalPosition(), verticalPosition(),
@@ -27,8 +33,8 @@ Pseudo3DVehicle::Pseudo3DVehicle()
   virtualOrientation(),
   onAir(false), onLongAir(false),
   isTireBurnoutOccurring(false), isCrashing(false),
-  engineSound(), spriteSpec(), sprites(), brakelightSprite(null), shadowSprite(null), smokeSprite(null),
-  spriteAssetsAreShared(false), soundAssetsAreShared(false)
+  engineSound(), spriteSpec(), sprites(), brakelightSprite(null), shadowSprite(null), smokeSprite(null), spriteMipLevels(),
+  spriteAssetsAreShared(false)
 {}
 
 Pseudo3DVehicle::~Pseudo3DVehicle()
@@ -42,7 +48,7 @@ void Pseudo3DVehicle::setSpec(const Spec& spec, int alternateSpriteIndex)
 	body = Mechanics(Engine(spec.engineMaximumRpm, spec.engineMaximumPower, spec.enginePowerBand, spec.engineGearCount), spec.type, spec.dragArea, spec.liftArea);
 	spriteSpec = alternateSpriteIndex == -1? spec.sprite : spec.alternateSprites[alternateSpriteIndex];
 	brakelightSprite = shadowSprite = smokeSprite = null;
-	spriteAssetsAreShared = soundAssetsAreShared = false;
+	spriteAssetsAreShared = false;
 
 	engineSound.setProfile(spec.soundProfile, spec.engineMaximumRpm);
 
@@ -69,14 +75,20 @@ void Pseudo3DVehicle::setSpec(const Spec& spec, int alternateSpriteIndex)
 	body.weightDistribution = spec.weightDistribution;
 	body.centerOfGravityHeight = spec.centerOfGravityHeight;
 	body.wheelbase = spec.wheelbase;
+
+	// needs to be done after setting the gear ratios
+	body.computeShiftSchedule();
 }
 
 void Pseudo3DVehicle::loadGraphicAssetsData()
 {
-	fgeal::Image* sheet = new fgeal::Image(spriteSpec.sheetFilename);
+	fgeal::Image* sheet = ImageCache::acquire(spriteSpec.sheetFilename);
 
 	if(sheet->getWidth() < (int) spriteSpec.frameWidth)
+	{
+		ImageCache::release(sheet);
 		throw std::runtime_error("Invalid sprite width value. Value is smaller than sprite sheet width (no whole sprites could be draw)");
+	}
 
 	for(unsigned i = 0; i < spriteSpec.stateCount; i++)
 	{
@@ -94,22 +106,41 @@ void Pseudo3DVehicle::loadGraphicAssetsData()
 		sprites.push_back(sprite);
 	}
 
+	// distant vehicles are drawn from smaller sheets, instead of minifying the full sheet on every frame
+	for(unsigned level = 1; level <= SPRITE_MIP_LEVEL_COUNT
+			and ImageCache::getMipLevelCellSize(spriteSpec.frameWidth, level) >= MINIMUM_MIP_LEVEL_FRAME_SIZE
+			and ImageCache::getMipLevelCellSize(spriteSpec.frameHeight, level) >= MINIMUM_MIP_LEVEL_FRAME_SIZE; level++)
+	{
+		fgeal::Image* levelSheet = ImageCache::acquireMipLevel(spriteSpec.sheetFilename, level, spriteSpec.frameWidth, spriteSpec.frameHeight);
+		const unsigned levelFrameWidth = ImageCache::getMipLevelCellSize(spriteSpec.frameWidth, level),
+					   levelFrameHeight = ImageCache::getMipLevelCellSize(spriteSpec.frameHeight, level);
+
+		// same layout as the sprites above: each sprite is on the row of same index, with right-leaning ones (if any) depicting the same states as the left-leaning ones
+		spriteMipLevels.push_back(vector<Sprite*>());
+		for(unsigned i = 0; i < sprites.size(); i++)
+		{
+			const unsigned state = (i < spriteSpec.stateCount? i : i - spriteSpec.stateCount + 1);
+			spriteMipLevels.back().push_back(new fgeal::Sprite(levelSheet, levelFrameWidth, levelFrameHeight,
+					spriteSpec.frameDurationProportionalToSpeed? 1.0 : spriteSpec.frameDuration, spriteSpec.stateFrameCount[state], 0, i*levelFrameHeight, false));
+		}
+	}
+
 	if(not spriteSpec.brakelightsSheetFilename.empty())
 	{
-		fgeal::Image* brakelightSpriteImage = new fgeal::Image(spriteSpec.brakelightsSheetFilename);
+		fgeal::Image* brakelightSpriteImage = ImageCache::acquire(spriteSpec.brakelightsSheetFilename);  // released in freeAssetsData()
 		if(spriteSpec.brakelightsMultipleSprites)
 			brakelightSprite = new fgeal::Sprite(
 				brakelightSpriteImage,
 				brakelightSpriteImage->getWidth(),
 				brakelightSpriteImage->getHeight()/spriteSpec.stateCount,
-				-1, spriteSpec.stateCount, 0, 0, true
+				-1, spriteSpec.stateCount, 0, 0, false
 			);
 		else
 			brakelightSprite = new fgeal::Sprite(
 				brakelightSpriteImage,
 				brakelightSpriteImage->getWidth(),
 				brakelightSpriteImage->getHeight(),
-				-1, true
+				-1, false
 			);
 
 		brakelightSprite->scale = spriteSpec.brakelightsSpriteScale;
@@ -117,12 +148,12 @@ void Pseudo3DVehicle::loadGraphicAssetsData()
 
 	if(not spriteSpec.shadowSheetFilename.empty())
 	{
-		fgeal::Image* shadowSpriteImage = new fgeal::Image(spriteSpec.shadowSheetFilename);
+		fgeal::Image* shadowSpriteImage = ImageCache::acquire(spriteSpec.shadowSheetFilename);  // released in freeAssetsData()
 		shadowSprite = new fgeal::Sprite(
 			shadowSpriteImage,
 			shadowSpriteImage->getWidth(),
 			shadowSpriteImage->getHeight()/spriteSpec.stateCount,
-			-1, spriteSpec.stateCount, 0, 0, true
+			-1, spriteSpec.stateCount, 0, 0, false
 		);
 
 		shadowSprite->scale = spriteSpec.scale;
@@ -133,7 +164,6 @@ void Pseudo3DVehicle::loadGraphicAssetsData()
 void Pseudo3DVehicle::loadSoundAssetsData()
 {
 	engineSound.loadAssetsData();
-	soundAssetsAreShared = false;
 }
 
 void Pseudo3DVehicle::loadGraphicAssetsData(const Pseudo3DVehicle* optionalBaseVehicle)
@@ -144,6 +174,7 @@ void Pseudo3DVehicle::loadGraphicAssetsData(const Pseudo3DVehicle* optionalBaseV
 		throw std::invalid_argument("Sprite spec. of the passed argument does not match this vehicle's.");
 
 	sprites = optionalBaseVehicle->sprites;
+	spriteMipLevels = optionalBaseVehicle->spriteMipLevels;
 	brakelightSprite = optionalBaseVehicle->brakelightSprite;
 	shadowSprite = optionalBaseVehicle->shadowSprite;
 	smokeSprite = optionalBaseVehicle->smokeSprite;
@@ -156,19 +187,77 @@ void Pseudo3DVehicle::loadSoundAssetsData(const Pseudo3DVehicle* baseVehicle)
 		throw std::invalid_argument("Argument is NULL");
 
 	engineSound = baseVehicle->engineSound;
-	soundAssetsAreShared = true;
+}
+
+vector<Image*> Pseudo3DVehicle::getGraphicAssetsImages() const
+{
+	vector<Image*> images;
+	if(not sprites.empty())
+		images.push_back(sprites[0]->image);
+
+	for(unsigned level = 0; level < spriteMipLevels.size(); level++)
+		if(not spriteMipLevels[level].empty())
+			images.push_back(spriteMipLevels[level][0]->image);
+
+	if(brakelightSprite != null)
+		images.push_back(brakelightSprite->image);
+
+	if(shadowSprite != null)
+		images.push_back(shadowSprite->image);
+
+	return images;
+}
+
+void Pseudo3DVehicle::moveGraphicAssetsDataToAtlas(const TextureAtlas& atlas)
+{
+	// each image is used by all sprites of a list, so it's released (once) only if they were relocated
+	vector<Image*> relocatedImages;
+
+	if(not sprites.empty())
+	{
+		Image* const sheet = sprites[0]->image;
+		for(unsigned i = 0; i < sprites.size(); i++)
+			if(atlas.relocate(*sprites[i]) and i == 0)
+				relocatedImages.push_back(sheet);
+	}
+
+	for(unsigned level = 0; level < spriteMipLevels.size(); level++)
+		if(not spriteMipLevels[level].empty())
+		{
+			Image* const levelSheet = spriteMipLevels[level][0]->image;
+			for(unsigned i = 0; i < spriteMipLevels[level].size(); i++)
+				if(atlas.relocate(*spriteMipLevels[level][i]) and i == 0)
+					relocatedImages.push_back(levelSheet);
+		}
+
+	if(brakelightSprite != null)
+	{
+		Image* const brakelightSpriteImage = brakelightSprite->image;
+		if(atlas.relocate(*brakelightSprite))
+			relocatedImages.push_back(brakelightSpriteImage);
+	}
+
+	if(shadowSprite != null)
+	{
+		Image* const shadowSpriteImage = shadowSprite->image;
+		if(atlas.relocate(*shadowSprite))
+			relocatedImages.push_back(shadowSpriteImage);
+	}
+
+	// pages are not cached images, so releasing them in freeAssetsData() is ignored
+	for(unsigned i = 0; i < relocatedImages.size(); i++)
+		ImageCache::release(relocatedImages[i]);
 }
 
 void Pseudo3DVehicle::freeAssetsData()
 {
-	if(not soundAssetsAreShared)
-		engineSound.freeAssetsData();
+	engineSound.freeAssetsData();
 
 	if(not spriteAssetsAreShared)
 	{
 		if(not sprites.empty())
 		{
-			delete sprites[0]->image;
+			ImageCache::release(sprites[0]->image);
 
 			for(unsigned i = 0; i < sprites.size(); i++)
 				delete sprites[i];
@@ -176,15 +265,30 @@ void Pseudo3DVehicle::freeAssetsData()
 			sprites.clear();
 		}
 
+		for(unsigned level = 0; level < spriteMipLevels.size(); level++)
+			if(not spriteMipLevels[level].empty())
+			{
+				ImageCache::release(spriteMipLevels[level][0]->image);
+				for(unsigned i = 0; i < spriteMipLevels[level].size(); i++)
+					delete spriteMipLevels[level][i];
+			}
+
 		if(brakelightSprite != null)
+		{
+			ImageCache::release(brakelightSprite->image);
 			delete brakelightSprite;
+		}
 
 		if(shadowSprite != null)
+		{
+			ImageCache::release(shadowSprite->image);
 			delete shadowSprite;
+		}
 
 		if(smokeSprite != null)
 			delete smokeSprite;
 	}
+	spriteMipLevels.clear();
 }
 
 void Pseudo3DVehicle::draw(float x, float y, float angle, float distanceScale, float cropY) const
@@ -231,9 +335,30 @@ void Pseudo3DVehicle::draw(float x, float y, float angle, float distanceScale, f
 		shadowSprite->scale = originalScale;
 	}
 
-	sprite.croppingArea.h = cropY;
-	sprite.draw(vehicleSpritePosition.x, vehicleSpritePosition.y);
-	sprite.croppingArea.h = 0;
+	// use the smallest prescaled level that is still minified (so it's not magnified), with the same frame, flip and position
+	unsigned level = 0;
+	while(level < spriteMipLevels.size() and sprite.scale.x * (2 << level) <= 1 and sprite.scale.y * (2 << level) <= 1)
+		level++;
+
+	if(level > 0)
+	{
+		Sprite& levelSprite = *spriteMipLevels[level-1][animationIndex];
+		const float levelFactorX = spriteSpec.frameWidth / static_cast<float>(levelSprite.width),
+					levelFactorY = spriteSpec.frameHeight / static_cast<float>(levelSprite.height);
+		levelSprite.scale.x = sprite.scale.x * levelFactorX;
+		levelSprite.scale.y = sprite.scale.y * levelFactorY;
+		levelSprite.flipmode = sprite.flipmode;
+		levelSprite.frameSequenceCurrentIndex = sprite.frameSequenceCurrentIndex;
+		levelSprite.croppingArea.h = cropY / levelFactorY;
+		levelSprite.draw(vehicleSpritePosition.x, vehicleSpritePosition.y);
+		levelSprite.croppingArea.h = 0;
+	}
+	else
+	{
+		sprite.croppingArea.h = cropY;
+		sprite.draw(vehicleSpritePosition.x, vehicleSpritePosition.y);
+		sprite.croppingArea.h = 0;
+	}
 
 	if(body.brakePedalPosition > 0 and brakelightSprite != null)
 	{
@@ -12,6 +12,7 @@
 #include "automotive/vehicle_spec.hpp"
 #include "automotive/engine_sound.hpp"
 #include "pseudo3d/vehicle_gfx.hpp"
+#include "gfx/texture_atlas.hpp"
 #include "fgeal/extra/sprite.hpp"
 
 #include <string>
@@ -56,6 +57,9 @@ struct Pseudo3DVehicle
 	std::vector<fgeal::Sprite*> sprites;
 	fgeal::Sprite* brakelightSprite, *shadowSprite, *smokeSprite;
 
+	// prescaled (successively half-sized) versions of the sprites, used when drawn small; level n is at index n-1 (see ImageCache::acquireMipLevel())
+	std::vector< std::vector<fgeal::Sprite*> > spriteMipLevels;
+
 	Pseudo3DVehicle();
 
 	~Pseudo3DVehicle();
@@ -78,7 +82,7 @@ struct Pseudo3DVehicle
 	/** Loads the graphic assets' data from the 'baseVehicle' argument to use its sprite data in this vehicle as well. The 'baseVehicle' "owns" the resources, though.  */
 	void loadGraphicAssetsData(const Pseudo3DVehicle* baseVehicle);
 
-	/** Loads the sound assets' data from the 'baseVehicle' argument to use its sound data in this vehicle as well. The 'baseVehicle' "owns" the resources, though. */
+	/** Loads the sound assets' data from the 'baseVehicle' argument to use its sound data in this vehicle as well. Both hold a reference to the resources (see SoundCache). */
 	void loadSoundAssetsData(const Pseudo3DVehicle* baseVehicle);
 
 	inline void loadAssetsData(const Pseudo3DVehicle* baseVehicle) {
@@ -86,6 +90,14 @@ struct Pseudo3DVehicle
 		loadSoundAssetsData(baseVehicle);
 	}
 
+	/** Returns the images from which this vehicle's graphics are drawn (sprite sheet, its prescaled levels, brake light and shadow). */
+	std::vector<fgeal::Image*> getGraphicAssetsImages() const;
+
+	/** Makes this vehicle's graphics be drawn from the given atlas, into which its images were packed (see getGraphicAssetsImages()).
+	 *  Images not packed are kept as they are; the others are released. Vehicles sharing this vehicle's assets are affected as well.
+	 *  The atlas must outlive this vehicle's graphic assets. */
+	void moveGraphicAssetsDataToAtlas(const TextureAtlas& atlas);
+
 	/** Draws this vehicle at the given position (x, y).
 	 *  The 'angle' argument specifies the angle to be depicted.
 	 *  The 'distanceScale' specifies how far the vehicle is depicted.
@@ -93,7 +105,7 @@ struct Pseudo3DVehicle
 	void draw(float x, float y, float angle=0, float distanceScale=1.0, float cropY=0) const;
 
 	private:
-	bool spriteAssetsAreShared, soundAssetsAreShared;
+	bool spriteAssetsAreShared;
 
 	// Disposes of loaded graphics and sounds assets.
 	void freeAssetsData();
@@ -9,6 +9,8 @@
 
 #include "carse_game.hpp"
 
+#include "gfx/image_cache.hpp"
+
 #include <vector>
 #include <iomanip>
 #include <sstream>
@@ -33,6 +35,12 @@ using futil::to_string;
 using std::vector;
 using std::string;
 
+// how many vehicles to each side of the selection have their sheets loaded ahead of time
+static const unsigned PREVIEW_PREFETCH_RADIUS = 4;
+
+// how much time (in seconds) per frame may be spent prefetching sheets (at least one sheet is loaded per frame, if any is pending)
+static const float PREVIEW_PREFETCH_TIME_SLICE = 0.004;
+
 static string toStrRounded(float value, unsigned placesCount=1)
 {
 	std::stringstream ss;
@@ -49,6 +57,7 @@ VehicleSelectionShowroomLayoutState::VehicleSelectionShowroomLayoutState(CarseGa
   selectButton(), backButton(),
   lastEnterSelectedVehicleIndex(0), lastEnterSelectedVehicleAltIndex(0),
   previewCurrentSprite(null), previewPreviousSprite(null), previewNextSprite(null),
+  previewPrefetcher(), previewPrefetchIndex(-1), previewPrefetchAltIndex(-1),
   imgBackground(null), imgArrow1(null), imgArrow2(null),
   isSelectionTransitioning(false), previousIndex(-1), selectionTransitionProgress(0)
 {}
@@ -60,23 +69,12 @@ VehicleSelectionShowroomLayoutState::~VehicleSelectionShowroomLayoutState()
 	if(fontInfo != null) delete fontInfo;
 	if(fontGui != null) delete fontGui;
 
-	if(previewCurrentSprite != null)
-		delete previewCurrentSprite;
-
-	if(previewPreviousSprite != null)
-		delete previewPreviousSprite;
-
-	if(previewNextSprite != null)
-		delete previewNextSprite;
-
-	if(imgBackground != null)
-		delete imgBackground;
-
-	if(imgArrow1 != null)
-		delete imgArrow1;
-
-	if(imgArrow2 != null)
-		delete imgArrow2;
+	ImageCache::release(previewCurrentSprite);
+	ImageCache::release(previewPreviousSprite);
+	ImageCache::release(previewNextSprite);
+	ImageCache::release(imgBackground);
+	ImageCache::release(imgArrow1);
+	ImageCache::release(imgArrow2);
 }
 
 void VehicleSelectionShowroomLayoutState::initialize()
@@ -109,9 +107,9 @@ void VehicleSelectionShowroomLayoutState::initialize()
 	selectButton = backButton;
 	selectButton.label = " Select ";
 
-	imgBackground = new Image("assets/showroom-bg.jpg");
-	imgArrow1 = new Image("assets/arrow-red.png");
-	imgArrow2 = new Image("assets/arrow-blue.png");
+	imgBackground = ImageCache::acquire("assets/showroom-bg.jpg");
+	imgArrow1 = ImageCache::acquire("assets/arrow-red.png");
+	imgArrow2 = ImageCache::acquire("assets/arrow-blue.png");
 }
 
 void VehicleSelectionShowroomLayoutState::onEnter()
@@ -164,10 +162,17 @@ void VehicleSelectionShowroomLayoutState::onEnter()
 }
 
 void VehicleSelectionShowroomLayoutState::onLeave()
-{}
+{
+	// sheets not in use are only kept while they fit in the cache's budget
+	previewPrefetcher.clear();
+	previewPrefetchIndex = previewPrefetchAltIndex = -1;
+}
 
 void VehicleSelectionShowroomLayoutState::update(float delta)
 {
+	updatePreviewPrefetchWindow();
+	previewPrefetcher.process(PREVIEW_PREFETCH_TIME_SLICE);
+
 	bool justFinishedTransitioning = false;
 	if(isSelectionTransitioning)
 	{
@@ -224,23 +229,52 @@ void VehicleSelectionShowroomLayoutState::update(float delta)
 
 void VehicleSelectionShowroomLayoutState::reloadSpriteIfMiss(unsigned menuIndex, Image*& previewSprite, string& previewSpriteFilename)
 {
-	const vector<Pseudo3DVehicle::Spec>& vehiclesSpecs = game.logic.getVehicleList();
-	if(previewSprite == null
-		or (previewAltIndex[menuIndex] == -1 and previewSpriteFilename != vehiclesSpecs[menuIndex].sprite.sheetFilename)
-		or (previewAltIndex[menuIndex] >=  0 and previewSpriteFilename != vehiclesSpecs[menuIndex].alternateSprites[previewAltIndex[menuIndex]].sheetFilename))
+	const string& sheetFilename = getPreviewSheetFilename(menuIndex, previewAltIndex[menuIndex]);
+	if(previewSprite == null or previewSpriteFilename != sheetFilename)
 	{
-		if(previewSprite != null)
-			delete previewSprite;
+		ImageCache::release(previewSprite);  // stays cached for a while, in case the user scrolls back
+		previewSpriteFilename = sheetFilename;
+		previewSprite = ImageCache::acquire(previewSpriteFilename);  // usually a cache hit, thanks to the prefetcher
+	}
+}
 
-		const Pseudo3DVehicle::Spec& spec = vehiclesSpecs[menuIndex];
+void VehicleSelectionShowroomLayoutState::updatePreviewPrefetchWindow()
+{
+	const int selected = menu.getSelectedIndex(), count = menu.getEntries().size();
+	if(count == 0 or (selected == previewPrefetchIndex and previewAltIndex[selected] == previewPrefetchAltIndex))
+		return;
 
-		if(previewAltIndex[menuIndex] == -1)
-			previewSpriteFilename = spec.sprite.sheetFilename;
-		else
-			previewSpriteFilename = spec.alternateSprites[previewAltIndex[menuIndex]].sheetFilename;
+	// the side the selection is moving to comes first (when scrolling fast, the other side is probably not going to be needed)
+	const bool forward = previewPrefetchIndex == -1 or (selected - previewPrefetchIndex + count) % count <= count/2;
 
-		previewSprite = new Image(previewSpriteFilename);
+	vector<string> window;
+	window.push_back(getPreviewSheetFilename(selected, previewAltIndex[selected]));
+	for(int distance = 1; distance <= (int) PREVIEW_PREFETCH_RADIUS and 2*distance <= count; distance++)
+	{
+		const int ahead = (selected + (forward? distance : -distance) + count) % count,
+		          behind = (selected + (forward? -distance : distance) + count) % count;
+		window.push_back(getPreviewSheetFilename(ahead, previewAltIndex[ahead]));
+		window.push_back(getPreviewSheetFilename(behind, previewAltIndex[behind]));
 	}
+
+	// the neighbouring appearances of the selected vehicle, in case the user browses them
+	const int alternateSpritesCount = game.logic.getVehicleList()[selected].alternateSprites.size();
+	if(alternateSpritesCount > 0)
+	{
+		const int altIndex = previewAltIndex[selected];
+		window.push_back(getPreviewSheetFilename(selected, altIndex == alternateSpritesCount - 1? -1 : altIndex + 1));
+		window.push_back(getPreviewSheetFilename(selected, altIndex == -1? alternateSpritesCount - 1 : altIndex - 1));
+	}
+
+	previewPrefetcher.setWindow(window);  // drops requests for sheets no longer around the selection
+	previewPrefetchIndex = selected;
+	previewPrefetchAltIndex = previewAltIndex[selected];
+}
+
+const string& VehicleSelectionShowroomLayoutState::getPreviewSheetFilename(unsigned menuIndex, int altIndex) const
+{
+	const Pseudo3DVehicle::Spec& spec = game.logic.getVehicleList()[menuIndex];
+	return altIndex == -1? spec.sprite.sheetFilename : spec.alternateSprites[altIndex].sheetFilename;
 }
 
 void VehicleSelectionShowroomLayoutState::render()
@@ -11,6 +11,8 @@
 
 #include "vehicle.hpp"
 
+#include "gfx/image_prefetcher.hpp"
+
 #include "fgeal/fgeal.hpp"
 #include "fgeal/extra/game.hpp"
 #include "fgeal/extra/menu.hpp"
@@ -46,6 +48,10 @@ class VehicleSelectionShowroomLayoutState extends public fgeal::Game::State
 	std::string previewCurrentSpriteFilename, previewPreviousSpriteFilename, previewNextSpriteFilename;
 	std::vector<int> previewAltIndex;
 
+	// loads the sheets around the selection ahead of time; the selection (and its appearance) the current window was built for
+	ImagePrefetcher previewPrefetcher;
+	int previewPrefetchIndex, previewPrefetchAltIndex;
+
 	fgeal::Image* imgBackground, *imgArrow1, *imgArrow2;
 	bool isSelectionTransitioning;
 	int previousIndex;
@@ -77,6 +83,8 @@ class VehicleSelectionShowroomLayoutState extends public fgeal::Game::State
 	void handleInput();
 	void menuSelectionAction();
 	void reloadSpriteIfMiss(unsigned menuIndex, fgeal::Image*& previewSprite, std::string& previewSpriteFilename);
+	void updatePreviewPrefetchWindow();
+	const std::string& getPreviewSheetFilename(unsigned menuIndex, int altIndex) const;
 };
 
 #endif /* VEHICLE_SELECTION_SHOWROOM_LAYOUT_STATE_HPP_ */
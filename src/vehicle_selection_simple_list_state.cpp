@@ -11,6 +11,8 @@
 
 #include "util.hpp"
 
+#include "gfx/image_cache.hpp"
+
 #include <vector>
 #include <iomanip>
 #include <sstream>
@@ -60,8 +62,7 @@ VehicleSelectionSimpleListState::~VehicleSelectionSimpleListState()
 	if(fontInfo != null) delete fontInfo;
 	if(fontSub != null) delete fontSub;
 
-	if(previewSprite != null)
-		delete previewSprite;
+	ImageCache::release(previewSprite);
 }
 
 void VehicleSelectionSimpleListState::initialize()
@@ -190,8 +191,7 @@ void VehicleSelectionSimpleListState::update(float delta)
 		or (previewAltIndex[menu.getSelectedIndex()] == -1 and previewSpriteFilename != vehiclesSpecs[menu.getSelectedIndex()].sprite.sheetFilename)
 		or (previewAltIndex[menu.getSelectedIndex()] >=  0 and previewSpriteFilename != vehiclesSpecs[menu.getSelectedIndex()].alternateSprites[previewAltIndex[menu.getSelectedIndex()]].sheetFilename))
 	{
-		if(previewSprite != null)
-			delete previewSprite;
+		ImageCache::release(previewSprite);  // stays cached for a while, in case the user scrolls back
 
 		const Pseudo3DVehicle::Spec& spec = vehiclesSpecs[menu.getSelectedIndex()];
 
@@ -200,7 +200,7 @@ void VehicleSelectionSimpleListState::update(float delta)
 		else
 			previewSpriteFilename = spec.alternateSprites[previewAltIndex[menu.getSelectedIndex()]].sheetFilename;
 
-		previewSprite = new Image(previewSpriteFilename);
+		previewSprite = ImageCache::acquire(previewSpriteFilename);
 	}
 }
 
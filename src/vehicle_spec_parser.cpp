@@ -114,7 +114,7 @@ void Pseudo3DVehicle::Spec::loadFromFile(const string& filename)
 
 	// read sound data if a custom one is specified
 	key = "sound";
-	if(prop.get(key) == "custom")
+	if(prop.get(key) == "custom" or prop.get(key) == "synthesized")
 		soundProfile = CarseLogic::createEngineSoundProfileFromFile(filename);
 	else if(prop.get(key) != "no")
 		soundProfile = logic.getPresetEngineSoundProfile(prop.get(key));